@@ -0,0 +1,309 @@
+/*  board.h provides the bitboard representation of a reversi position
+ *  together with the move generator.  A position is held relative to
+ *  the side to move: player owns the discs of the side about to play
+ *  and opponent owns the rest.  Passing the move to the other side is
+ *  therefore a plain swap of the two sets.
+ */
+
+#if !defined(board_h)
+#  define board_h
+
+#define MAXX                         8
+#define MAXY                         8
+#define MAXPOS                       (MAXX*MAXY)
+#define FILE_A                       0x0101010101010101ULL
+#define FILE_H                       0x8080808080808080ULL
+#define NOT_FILE_A                   (~FILE_A)
+#define NOT_FILE_H                   (~FILE_H)
+#define CORNERS                      0x8100000000000081ULL
+#define RANK_1                       0x00000000000000ffULL
+#define RANK_8                       0xff00000000000000ULL
+#define EDGES                        (FILE_A | FILE_H | RANK_1 | RANK_8)
+#define ALL_SQUARES                  (~0ULL)
+
+#define WHITE               1
+#define BLACK               0
+
+typedef unsigned long long BITSET64;
+
+typedef struct board_t {
+  BITSET64 player;     /* discs of the side to move.  */
+  BITSET64 opponent;   /* discs of the other side.  */
+} board;
+
+
+/*
+ *  popCount - returns the number of bits present in, set.  The
+ *             hardware instruction is used when the compiler has been
+ *             told the cpu has one (-mpopcnt), otherwise the bits are
+ *             summed in parallel within the word.
+ */
+
+static __inline__ int board_popCount (BITSET64 set)
+{
+#if defined(__POPCNT__)
+  return __builtin_popcountll(set);
+#else
+  set = set - ((set >> 1) & 0x5555555555555555ULL);
+  set = (set & 0x3333333333333333ULL) + ((set >> 2) & 0x3333333333333333ULL);
+  set = (set + (set >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (int) ((set * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/*
+ *  lowestBit - returns the index of the lowest bit present in, set.
+ *              set must not be empty.
+ */
+
+static __inline__ int board_lowestBit (BITSET64 set)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(set);
+#else
+  int bit = 0;
+
+  while ((set & 1) == 0) {
+    set >>= 1;
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+/*
+ *  fillUp - Kogge-Stone occluded fill of, gen, through the propagator
+ *           set, pro, towards higher bit numbers in steps of, s.
+ *           pro must already exclude the squares which would wrap
+ *           around the board edge.
+ */
+
+static __inline__ BITSET64 board_fillUp (BITSET64 gen, BITSET64 pro, int s)
+{
+  gen |= pro & (gen << s);
+  pro &= (pro << s);
+  gen |= pro & (gen << (2*s));
+  pro &= (pro << (2*s));
+  gen |= pro & (gen << (4*s));
+  return gen;
+}
+
+/*
+ *  fillDown - Kogge-Stone occluded fill of, gen, through the propagator
+ *             set, pro, towards lower bit numbers in steps of, s.
+ */
+
+static __inline__ BITSET64 board_fillDown (BITSET64 gen, BITSET64 pro, int s)
+{
+  gen |= pro & (gen >> s);
+  pro &= (pro >> s);
+  gen |= pro & (gen >> (2*s));
+  pro &= (pro >> (2*s));
+  gen |= pro & (gen >> (4*s));
+  return gen;
+}
+
+/*
+ *  legalMoves - returns the set of squares on which the side to move
+ *               may play.  All eight directions are propagated at once
+ *               over the whole board.
+ */
+
+static __inline__ BITSET64 board_legalMoves (board b)
+{
+  BITSET64 p = b.player;
+  BITSET64 o = b.opponent;
+  BITSET64 empty = ~(p | o);
+  BITSET64 oa = o & NOT_FILE_A;
+  BITSET64 oh = o & NOT_FILE_H;
+  BITSET64 moves;
+
+  moves  = ((board_fillUp (p, oa, 1) & o) << 1) & NOT_FILE_A;    /* right */
+  moves |= ((board_fillDown (p, oh, 1) & o) >> 1) & NOT_FILE_H;  /* left */
+  moves |= (board_fillUp (p, o, MAXX) & o) << MAXX;              /* up */
+  moves |= (board_fillDown (p, o, MAXX) & o) >> MAXX;            /* down */
+  moves |= ((board_fillUp (p, oa, MAXX+1) & o) << (MAXX+1)) & NOT_FILE_A;    /* diag right up */
+  moves |= ((board_fillDown (p, oh, MAXX+1) & o) >> (MAXX+1)) & NOT_FILE_H;  /* diag left down */
+  moves |= ((board_fillUp (p, oh, MAXX-1) & o) << (MAXX-1)) & NOT_FILE_H;    /* diag left up */
+  moves |= ((board_fillDown (p, oa, MAXX-1) & o) >> (MAXX-1)) & NOT_FILE_A;  /* diag right down */
+  return moves & empty;
+}
+
+/*
+ *  bracket - returns, run, providing the square beyond it, end, is
+ *            one of our discs otherwise the empty set is returned.
+ */
+
+static __inline__ BITSET64 board_bracket (BITSET64 run, BITSET64 end)
+{
+  return run & (- (BITSET64) (end != 0));
+}
+
+/*
+ *  flipMask - returns the set of opponent discs which are turned over
+ *             should the side to move play on square, pos.
+ */
+
+static __inline__ BITSET64 board_flipMask (board b, int pos)
+{
+  BITSET64 p = b.player;
+  BITSET64 o = b.opponent;
+  BITSET64 bit = ((BITSET64) 1) << pos;
+  BITSET64 oa = o & NOT_FILE_A;
+  BITSET64 oh = o & NOT_FILE_H;
+  BITSET64 f;
+  BITSET64 flips;
+
+  f = board_fillUp (bit, oa, 1);
+  flips  = board_bracket (f & o, (f << 1) & NOT_FILE_A & p);
+  f = board_fillDown (bit, oh, 1);
+  flips |= board_bracket (f & o, (f >> 1) & NOT_FILE_H & p);
+  f = board_fillUp (bit, o, MAXX);
+  flips |= board_bracket (f & o, (f << MAXX) & p);
+  f = board_fillDown (bit, o, MAXX);
+  flips |= board_bracket (f & o, (f >> MAXX) & p);
+  f = board_fillUp (bit, oa, MAXX+1);
+  flips |= board_bracket (f & o, (f << (MAXX+1)) & NOT_FILE_A & p);
+  f = board_fillDown (bit, oh, MAXX+1);
+  flips |= board_bracket (f & o, (f >> (MAXX+1)) & NOT_FILE_H & p);
+  f = board_fillUp (bit, oh, MAXX-1);
+  flips |= board_bracket (f & o, (f << (MAXX-1)) & NOT_FILE_H & p);
+  f = board_fillDown (bit, oa, MAXX-1);
+  flips |= board_bracket (f & o, (f >> (MAXX-1)) & NOT_FILE_A & p);
+  return flips;
+}
+
+/*
+ *  neighbours - returns the squares next to any square in, set, in
+ *               any of the eight directions.
+ */
+
+static __inline__ BITSET64 board_neighbours (BITSET64 set)
+{
+  BITSET64 h = set | ((set << 1) & NOT_FILE_A) | ((set >> 1) & NOT_FILE_H);
+
+  return (h | (h << MAXX) | (h >> MAXX)) & ~set;
+}
+
+/*
+ *  frontier - returns the discs in, own, which are next to an empty
+ *             square, given the occupied squares, u.
+ */
+
+static __inline__ BITSET64 board_frontier (BITSET64 own, BITSET64 u)
+{
+  return own & board_neighbours (~u);
+}
+
+/*
+ *  fullLines - assigns, h, v, d and a with the squares whose row,
+ *              column, diagonal and anti diagonal respectively are
+ *              full, given the occupied squares, u.  The empty squares
+ *              are filled along each line and whatever they do not
+ *              reach is full.
+ */
+
+static __inline__ void board_fullLines (BITSET64 u, BITSET64 *h, BITSET64 *v,
+					BITSET64 *d, BITSET64 *a)
+{
+  BITSET64 empty = ~u;
+
+  *h = ~(board_fillUp (empty, NOT_FILE_A, 1) | board_fillDown (empty, NOT_FILE_H, 1));
+  *v = ~(board_fillUp (empty, ALL_SQUARES, MAXX) | board_fillDown (empty, ALL_SQUARES, MAXX));
+  *d = ~(board_fillUp (empty, NOT_FILE_A, MAXX+1) | board_fillDown (empty, NOT_FILE_H, MAXX+1));
+  *a = ~(board_fillUp (empty, NOT_FILE_H, MAXX-1) | board_fillDown (empty, NOT_FILE_A, MAXX-1));
+}
+
+/*
+ *  stable - returns a subset of the discs in, own, which can never be
+ *           turned over, given the occupied squares, u.  A disc cannot
+ *           be turned over along a line if the line is full, or if it
+ *           lies on the edge of the board, or if the disc beside it on
+ *           the line is one of its own stable discs.  A disc for which
+ *           this holds along all four lines through it is stable, and
+ *           starting from the corners the stable discs are grown from
+ *           those already found until no more are.  The shifts need no
+ *           masks as any which wrap around land on an edge square.
+ */
+
+static __inline__ BITSET64 board_stable (BITSET64 own, BITSET64 u)
+{
+  BITSET64 fh, fv, fd, fa;
+  BITSET64 stable, grown;
+
+  board_fullLines (u, &fh, &fv, &fd, &fa);
+  fh |= FILE_A | FILE_H;
+  fv |= RANK_1 | RANK_8;
+  fd |= EDGES;
+  fa |= EDGES;
+  stable = own & ((fh & fv & fd & fa) | CORNERS);
+  if (stable == 0)
+    return 0;
+  do {
+    grown = stable;
+    stable |= own
+      & (fh | (stable << 1) | (stable >> 1))
+      & (fv | (stable << MAXX) | (stable >> MAXX))
+      & (fd | (stable << (MAXX+1)) | (stable >> (MAXX+1)))
+      & (fa | (stable << (MAXX-1)) | (stable >> (MAXX-1)));
+  } while (stable != grown);
+  return stable;
+}
+
+/*
+ *  play - returns the position after the side to move places a disc
+ *         on square, pos, turning over the discs in, flips.  The
+ *         result is still seen from the side which has just moved.
+ */
+
+static __inline__ board board_play (board b, int pos, BITSET64 flips)
+{
+  b.player |= flips | (((BITSET64) 1) << pos);
+  b.opponent &= ~flips;
+  return b;
+}
+
+/*
+ *  swap - returns the position with the move handed to the other side.
+ */
+
+static __inline__ board board_swap (board b)
+{
+  board s;
+
+  s.player = b.opponent;
+  s.opponent = b.player;
+  return s;
+}
+
+/*
+ *  fromColours - returns the position held in the colour set, c, and
+ *                the occupied set, u, seen from the side, colour.
+ */
+
+static __inline__ board board_fromColours (BITSET64 c, BITSET64 u, int colour)
+{
+  board b;
+
+  b.player = u & c;
+  b.opponent = u & ~c;
+  if (colour == WHITE)
+    return b;
+  return board_swap (b);
+}
+
+/*
+ *  toColours - assigns the colour set, c, and the occupied set, u,
+ *              from position, b, seen from the side, colour.
+ */
+
+static __inline__ void board_toColours (board b, int colour, BITSET64 *c, BITSET64 *u)
+{
+  *u = b.player | b.opponent;
+  if (colour == WHITE)
+    *c = b.player;
+  else
+    *c = b.opponent;
+}
+
+#endif /* !board_h.  */
@@ -0,0 +1,54 @@
+/*  engine.h provides the search of paro64bit.c to other programs, such
+ *  as the trainer, which build it with TRAINER defined in place of its
+ *  own main program.  Every thread has its own search state, only the
+ *  transposition table and the pattern weights are shared, so any
+ *  number of threads may search at once.  Scores are in discs seen
+ *  from the side to move of position, b.
+ */
+
+#if !defined(engine_h)
+#  define engine_h
+#  if defined(engine_c)
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN
+#     endif /* !__GNUG__.  */
+#  else /* !engine_c.  */
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN extern
+#     endif /* !__GNUG__.  */
+#  endif /* !engine_c.  */
+
+#include "board.h"
+
+
+/*
+ *  search - return the score of position, b, searched, depth, plies
+ *           ahead and assign the best move to, move.  The side to move
+ *           must have a legal move.
+ */
+
+EXTERN int engine_search (board b, int depth, int *move);
+
+
+/*
+ *  solve - return the final score of position, b, with perfect play
+ *          and assign the best move to, move.  The side to move must
+ *          have a legal move.
+ */
+
+EXTERN int engine_solve (board b, int *move);
+
+
+/*
+ *  explored - return the number of positions the calling thread has
+ *             evaluated since the last call.
+ */
+
+EXTERN int engine_explored (void);
+
+#  undef EXTERN
+#endif /* !engine_h.  */
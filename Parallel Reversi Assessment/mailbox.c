@@ -1,126 +1,410 @@
-#define mailbox_c
-
-#include "mailbox.h"
-
-#define NO_MAILBOXES 30
-
-static void *shared_memory = NULL;
-static mailbox *freelist = NULL;  /* list of free mailboxes.  */
-
-
-/*
- *  initialise the data structures of mailbox.  Assign prev to the
- *  mailbox prev field.
- */
-
-static mailbox *mailbox_config (mailbox *mbox, mailbox *prev)
-{
-  mbox->in = 0; // My line of code
-  mbox->out = 0; // My line of code
-  // mbox->data.result = 0; // Unrequired line of code
-  // mbox->data.move_no = 0; // Unrequired line of code
-  // mbox->data.positions_explored = 0; // Unrequired line of code
-  mbox->prev = prev;
-  mbox->item_available = multiprocessor_initSem (0);
-  mbox->space_available = multiprocessor_initSem (MAX_MAILBOX_DATA); // My line of code
-  mbox->mutex = multiprocessor_initSem (1);
-  return mbox;
-}
-
-
-/*
- *  init_memory - initialise the shared memory region once.
- *                It also initialises all mailboxes.
- */
-
-static void init_memory (void)
-{
-  if (shared_memory == NULL)
-    {
-      mailbox *mbox;
-      mailbox *prev = NULL;
-      int i;
-      _M2_multiprocessor_init ();
-      shared_memory = multiprocessor_initSharedMemory
-	(NO_MAILBOXES * sizeof (mailbox));
-      mbox = shared_memory;
-      for (i = 0; i < NO_MAILBOXES; i++)
-	prev = mailbox_config (&mbox[i], prev);
-      freelist = prev;
-    }
-}
-
-
-/*
- *  init - create a single mailbox which can contain a single triple.
- */
-
-mailbox *mailbox_init (void)
-{
-  mailbox *mbox;
-
-  init_memory ();
-  if (freelist == NULL)
-    {
-      printf ("exhausted mailboxes\n");
-      exit (1);
-    }
-  mbox = freelist;
-  freelist = freelist->prev;
-  return mbox;
-}
-
-
-/*
- *  kill - return the mailbox to the freelist.  No process must use this
- *         mailbox.
- */
-
-mailbox *mailbox_kill (mailbox *mbox)
-{
-  mbox->prev = freelist;
-  freelist = mbox;
-  return NULL;
-}
-
-
-/*
- *  send - send (result, move_no, positions_explored) to the mailbox mbox.
- */
-
-void mailbox_send (mailbox *mbox, int result, int move_no, int positions_explored)
-{
-  // My code
-  multiprocessor_wait(mbox->space_available);
-  multiprocessor_wait(mbox->mutex);
-
-  mbox->data[mbox->in].result = result;
-  mbox->data[mbox->in].move_no = move_no;
-  mbox->data[mbox->in].positions_explored = positions_explored;
-  mbox->in = (mbox->in + 1) % MAX_MAILBOX_DATA;
-
-  multiprocessor_signal(mbox->mutex);
-  multiprocessor_signal(mbox->item_available);
-}
-
-
-/*
- *  rec - receive (result, move_no, positions_explored) from the
- *        mailbox mbox.
- */
-
-void mailbox_rec (mailbox *mbox,
-		  int *result, int *move_no, int *positions_explored)
-{
-  // My code
-  multiprocessor_wait(mbox->item_available);
-  multiprocessor_wait(mbox->mutex);
-
-  *result = mbox->data[mbox->out].result;
-  *move_no = mbox->data[mbox->out].move_no;
-  *positions_explored = mbox->data[mbox->out].positions_explored;
-  mbox->out = (mbox->out + 1) % MAX_MAILBOX_DATA;
-
-  multiprocessor_signal(mbox->mutex);
-  multiprocessor_signal(mbox->space_available);
-}
+#define mailbox_c
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "mailbox.h"
+
+#if !defined(TRUE)
+#  define TRUE (1==1)
+#endif
+
+#if !defined(FALSE)
+#  define FALSE (1==0)
+#endif
+
+#define SPINS  128   /* looks at a full or empty mailbox before sleeping.  */
+
+static mailbox *freelist = NULL;  /* list of free mailboxes.  */
+
+
+/*
+ *  futexWait - sleep while the futex, word, still contains, value.
+ *              The mailboxes may be shared between processes, so the
+ *              futex is not process private.
+ */
+
+static void futexWait (atomic_uint *word, unsigned int value)
+{
+  syscall (SYS_futex, word, FUTEX_WAIT, value, NULL, NULL, 0);
+}
+
+
+/*
+ *  futexWake - wake every process or thread sleeping on futex, word.
+ */
+
+static void futexWake (atomic_uint *word)
+{
+  syscall (SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+
+/*
+ *  sleepUntil - sleep on the futex, word, unless the sequence number,
+ *               seq, has already become, ready.  sleepers counts the
+ *               processes about to sleep on word, so that wakeUp only
+ *               enters the kernel when it must.
+ */
+
+static void sleepUntil (atomic_uint *sleepers, atomic_uint *word,
+			atomic_uint *seq, unsigned int ready)
+{
+  unsigned int value = atomic_load (word);
+
+  atomic_fetch_add (sleepers, 1);
+  if (atomic_load (seq) != ready)
+    futexWait (word, value);
+  atomic_fetch_sub (sleepers, 1);
+}
+
+
+/*
+ *  wakeUp - wake anyone sleeping on the futex, word.  It pairs with
+ *           sleepUntil, either the sleeper sees our change of sequence
+ *           number or we see the sleeper.
+ */
+
+static void wakeUp (atomic_uint *sleepers, atomic_uint *word)
+{
+  atomic_thread_fence (memory_order_seq_cst);
+  if (atomic_load_explicit (sleepers, memory_order_relaxed) > 0)
+    {
+      atomic_fetch_add (word, 1);
+      futexWake (word);
+    }
+}
+
+
+/*
+ *  header - return the header of the message at position, pos.
+ */
+
+static message *header (mailbox *mbox, unsigned int pos)
+{
+  return (message *) &mbox->arena[(pos & (mbox->units - 1)) * MAILBOX_UNIT];
+}
+
+
+/*
+ *  waitFor - wait until the sequence number of the unit at position,
+ *            pos, becomes, ready.  sleepers and word are the futex of
+ *            whoever is waiting, the receiver or the senders.
+ */
+
+static void waitFor (mailbox *mbox, unsigned int pos, unsigned int ready,
+		     atomic_uint *sleepers, atomic_uint *word)
+{
+  atomic_uint *seq = &mbox->seq[pos & (mbox->units - 1)];
+  int spins = 0;
+
+  while (atomic_load_explicit (seq, memory_order_acquire) != ready)
+    if (++spins > SPINS)
+      {
+	sleepUntil (sleepers, word, seq, ready);
+	spins = 0;
+      }
+}
+
+
+/*
+ *  releaseUnits - hand the, units, starting at position, pos, back to
+ *                 the senders for the next lap of the ring.
+ */
+
+static void releaseUnits (mailbox *mbox, unsigned int pos, unsigned int units)
+{
+  unsigned int i;
+
+  for (i = 0; i < units; i++)
+    atomic_store_explicit (&mbox->seq[(pos + i) & (mbox->units - 1)],
+			   pos + i + mbox->units, memory_order_release);
+  mbox->out = pos + units;
+  wakeUp (&mbox->sending, &mbox->spaces);
+}
+
+
+/*
+ *  initialise the data structures of mailbox, which has an arena of
+ *  units.
+ */
+
+static mailbox *mailbox_config (mailbox *mbox, unsigned int units)
+{
+  unsigned int i;
+
+  atomic_init (&mbox->in, 0);
+  mbox->out = 0;
+  atomic_init (&mbox->receiving, 0);
+  atomic_init (&mbox->items, 0);
+  atomic_init (&mbox->sending, 0);
+  atomic_init (&mbox->spaces, 0);
+  mbox->units = units;
+  mbox->prev = NULL;
+  for (i = 0; i < units; i++)
+    atomic_init (&mbox->seq[i], i);
+  return mbox;
+}
+
+
+/*
+ *  init - create a single mailbox which can contain MAX_MAILBOX_DATA
+ *         triples.
+ */
+
+mailbox *mailbox_init (void)
+{
+  return mailbox_initSize (MAX_MAILBOX_DATA
+			   * (sizeof (message) + sizeof (triple) + MAILBOX_UNIT - 1)
+			   / MAILBOX_UNIT * MAILBOX_UNIT);
+}
+
+
+/*
+ *  initSize - create a single mailbox with an arena of at least,
+ *             bytes.  The arena is rounded up to a power of two units.
+ */
+
+mailbox *mailbox_initSize (unsigned int bytes)
+{
+  mailbox **p;
+  mailbox *mbox;
+  unsigned int units = 2;
+  size_t seqSize;
+
+  while (units * MAILBOX_UNIT < bytes)
+    units *= 2;
+
+  /* reuse a free mailbox if one is large enough.  */
+  for (p = &freelist; *p != NULL; p = &(*p)->prev)
+    if ((*p)->units >= units)
+      {
+	mbox = *p;
+	*p = mbox->prev;
+	return mailbox_config (mbox, mbox->units);
+      }
+
+  /* the header, sequence numbers and arena are one block.  */
+  seqSize = (units * sizeof (atomic_uint) + MAILBOX_UNIT - 1)
+    / MAILBOX_UNIT * MAILBOX_UNIT;
+  mbox = (mailbox *) multiprocessor_allocSharedMemory
+    (sizeof (mailbox) + seqSize + units * MAILBOX_UNIT + MAILBOX_UNIT);
+  mbox->seq = (atomic_uint *) &mbox[1];
+  mbox->arena = (char *) (((unsigned long) mbox->seq + seqSize + MAILBOX_UNIT - 1)
+			  & ~(unsigned long) (MAILBOX_UNIT - 1));
+  return mailbox_config (mbox, units);
+}
+
+
+/*
+ *  kill - return the mailbox to the freelist.  No process must use this
+ *         mailbox.
+ */
+
+mailbox *mailbox_kill (mailbox *mbox)
+{
+  mbox->prev = freelist;
+  freelist = mbox;
+  return NULL;
+}
+
+
+/*
+ *  reserve - claim room in mailbox, mbox, for a message of, type, with
+ *            a payload of, length, bytes, blocking while it is full.
+ *            The address of the payload is returned for the sender to
+ *            fill in before calling commit.
+ *
+ *            A sender claims the units of its message with a compare
+ *            and swap on in.  A message never wraps around the end of
+ *            the arena, instead the rest of the arena is claimed as
+ *            well and filled with a MAILBOX_SKIP message.  A message
+ *            may therefore take no more than half the arena, as a
+ *            larger one and its skip together could overrun the
+ *            arena and wait on units the sender itself has claimed.
+ */
+
+void *mailbox_reserve (mailbox *mbox, int type, unsigned int length)
+{
+  unsigned int mask = mbox->units - 1;
+  unsigned int units = 1 + (length + MAILBOX_UNIT - 1) / MAILBOX_UNIT;
+  unsigned int pos = atomic_load_explicit (&mbox->in, memory_order_relaxed);
+  unsigned int skip, seq, i;
+  int spins = 0;
+  message *m;
+
+  if (units > mbox->units / 2)
+    {
+      printf ("message of %u bytes is too large for the mailbox\n", length);
+      exit (1);
+    }
+  for (;;)
+    {
+      skip = 0;
+      if ((pos & mask) + units > mbox->units)
+	skip = mbox->units - (pos & mask);
+      seq = atomic_load_explicit (&mbox->seq[pos & mask], memory_order_acquire);
+      if (seq == pos)
+	{
+	  if (atomic_compare_exchange_weak_explicit (&mbox->in, &pos, pos + skip + units,
+						     memory_order_relaxed,
+						     memory_order_relaxed))
+	    break;
+	}
+      else
+	{
+	  if ((int) (seq - pos) < 0 && ++spins > SPINS)
+	    {
+	      /* full, the unit is still in use from the last lap.  */
+	      sleepUntil (&mbox->sending, &mbox->spaces, &mbox->seq[pos & mask], pos);
+	      spins = 0;
+	    }
+	  pos = atomic_load_explicit (&mbox->in, memory_order_relaxed);
+	}
+    }
+
+  /* the rest of our units may still hold older messages.  */
+  for (i = 1; i < skip + units; i++)
+    waitFor (mbox, pos + i, pos + i, &mbox->sending, &mbox->spaces);
+
+  if (skip > 0)
+    {
+      m = header (mbox, pos);
+      m->type = MAILBOX_SKIP;
+      m->length = 0;
+      m->units = skip;
+      m->pos = pos;
+      mailbox_commit (mbox, &m[1]);
+      pos += skip;
+    }
+  m = header (mbox, pos);
+  m->type = type;
+  m->length = length;
+  m->units = units;
+  m->pos = pos;
+  return &m[1];
+}
+
+
+/*
+ *  commit - deliver the message whose payload, msg, was returned by
+ *           reserve.
+ */
+
+void mailbox_commit (mailbox *mbox, void *msg)
+{
+  message *m = &((message *) msg)[-1];
+
+  atomic_store_explicit (&mbox->seq[m->pos & (mbox->units - 1)], m->pos + 1,
+			 memory_order_release);
+  wakeUp (&mbox->receiving, &mbox->items);
+}
+
+
+/*
+ *  next - return the header of the oldest message in mailbox, mbox,
+ *         skipping any padding.  If, wait, is FALSE then NULL is
+ *         returned should the mailbox be empty.
+ */
+
+static message *next (mailbox *mbox, int wait)
+{
+  message *m;
+
+  for (;;)
+    {
+      if (wait)
+	waitFor (mbox, mbox->out, mbox->out + 1, &mbox->receiving, &mbox->items);
+      else if (atomic_load_explicit (&mbox->seq[mbox->out & (mbox->units - 1)],
+				     memory_order_acquire) != mbox->out + 1)
+	return NULL;
+      m = header (mbox, mbox->out);
+      if (m->type != MAILBOX_SKIP)
+	return m;
+      releaseUnits (mbox, mbox->out, m->units);
+    }
+}
+
+
+/*
+ *  receive - return the address of the payload of the oldest message
+ *            in mailbox, mbox, and assign its type and length.  It
+ *            blocks while the mailbox is empty.  The message remains
+ *            in the mailbox until release is called.
+ */
+
+void *mailbox_receive (mailbox *mbox, int *type, unsigned int *length)
+{
+  message *m = next (mbox, TRUE);
+
+  *type = m->type;
+  *length = m->length;
+  return &m[1];
+}
+
+
+/*
+ *  poll - as receive, but NULL is returned if the mailbox is empty.
+ */
+
+void *mailbox_poll (mailbox *mbox, int *type, unsigned int *length)
+{
+  message *m = next (mbox, FALSE);
+
+  if (m == NULL)
+    return NULL;
+  *type = m->type;
+  *length = m->length;
+  return &m[1];
+}
+
+
+/*
+ *  release - remove the message returned by receive or poll from the
+ *            mailbox, mbox.
+ */
+
+void mailbox_release (mailbox *mbox)
+{
+  releaseUnits (mbox, mbox->out, header (mbox, mbox->out)->units);
+}
+
+
+/*
+ *  send - send (result, move_no, positions_explored) to the mailbox mbox.
+ */
+
+void mailbox_send (mailbox *mbox, int result, int move_no, int positions_explored)
+{
+  triple *t = (triple *) mailbox_reserve (mbox, MAILBOX_TRIPLE, sizeof (triple));
+
+  t->result = result;
+  t->move_no = move_no;
+  t->positions_explored = positions_explored;
+  mailbox_commit (mbox, t);
+}
+
+
+/*
+ *  rec - receive (result, move_no, positions_explored) from the
+ *        mailbox mbox.
+ */
+
+void mailbox_rec (mailbox *mbox,
+		  int *result, int *move_no, int *positions_explored)
+{
+  unsigned int length;
+  int type;
+  triple *t = (triple *) mailbox_receive (mbox, &type, &length);
+
+  if (type != MAILBOX_TRIPLE)
+    {
+      printf ("mailbox_rec has received a message which is not a triple\n");
+      exit (1);
+    }
+  *result = t->result;
+  *move_no = t->move_no;
+  *positions_explored = t->positions_explored;
+  mailbox_release (mbox);
+}
@@ -1,82 +1,173 @@
-/*  mailbox.h provides a very simple mailbox datatype.
- *  Gaius Mulley <gaius.southwales@gmail.com>.
- */
-
-#include <stdio.h>
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <sys/sysinfo.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <time.h>
-#include <unistd.h>
-
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
-#include <semaphore.h>
-
-#include "multiprocessor.h"
-
-typedef struct triple_t {
-  int result;
-  int move_no;
-  int positions_explored;
-} triple;
-
-
-typedef struct mailbox_t {
-  triple data[MAX_MAILBOX_DATA]; // My line of code
-  int in; // My line of code
-  int out; // My line of code
-  sem_t *item_available;    /* are there data in the mailbox?  */
-  sem_t *space_available;   /* space for more data in the mailbox.  */
-  sem_t *mutex;             /* access to the mailbox.  */
-  struct mailbox_t *prev;  /* previous mailbox.  */
-} mailbox;
-
-
-#if !defined(mailbox_h)
-#  define mailbox_h
-#  if defined(mailbox_c)
-#     if defined(__GNUG__)
-#        define EXTERN extern "C"
-#     else /* !__GNUG__.  */
-#        define EXTERN
-#     endif /* !__GNUG__.  */
-#  else /* !mailbox_c.  */
-#     if defined(__GNUG__)
-#        define EXTERN extern "C"
-#     else /* !__GNUG__.  */
-#        define EXTERN extern
-#     endif /* !__GNUG__.  */
-#  endif /* !mailbox_c.  */
-
-
-/*
- *  init - create a single mailbox which can contain a single triple.
- */
-
-EXTERN mailbox *mailbox_init (void);
-
-
-/*
- *  send - send (result, move_no, positions_explored) to the mailbox mbox.
- */
-
-EXTERN void mailbox_send (mailbox *mbox,
-			  int result, int move_no, int positions_explored);
-
-
-/*
- *  rec - receive (result, move_no, positions_explored) from the
- *        mailbox mbox.
- */
-
-EXTERN void mailbox_rec (mailbox *mbox,
-			 int *result, int *move_no,
-			 int *positions_explored);
-
-#  undef EXTERN
-#endif /* !mailbox_h.  */
+/*  mailbox.h provides a very simple mailbox datatype.
+ *  Gaius Mulley <gaius.southwales@gmail.com>.
+ *
+ *  A mailbox is a ring buffer arena in shared memory which any number
+ *  of processes or threads may send to and a single one receives from.
+ *  Each message has a type and a payload of any length, both of which
+ *  are written and read in place within the arena.  Messages are
+ *  passed without locks using C11 atomics, a sender or the receiver
+ *  only sleeps (on a futex) when the mailbox is full or empty.
+ */
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/sysinfo.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <semaphore.h>
+
+#include "multiprocessor.h"
+
+#if !defined(MAX_MAILBOX_DATA)
+#  define MAX_MAILBOX_DATA  64   /* triples held by mailbox_init, enough for a result from every root move.  */
+#endif
+
+#define MAILBOX_UNIT        16   /* bytes, the arena is allocated in units.  */
+
+#define MAILBOX_SKIP         0   /* message types, padding to the end of the arena.  */
+#define MAILBOX_TRIPLE       1   /* used by mailbox_send and mailbox_rec.  */
+#define MAILBOX_USER        16   /* the first type free for the user.  */
+
+typedef struct triple_t {
+  int result;
+  int move_no;
+  int positions_explored;
+} triple;
+
+typedef struct message_t {
+  int type;
+  unsigned int length;        /* bytes in the payload which follows.  */
+  unsigned int units;         /* units used by the header and payload.  */
+  unsigned int pos;           /* position of the header in the ring.  */
+} message;
+
+typedef struct mailbox_t {
+  atomic_uint in;             /* next position to be claimed by a sender.  */
+  unsigned int pad1[15];      /* keep the senders and receiver on separate cache lines.  */
+  unsigned int out;           /* next position to be received, only used by the receiver.  */
+  atomic_uint receiving;      /* the receiver is asleep, or about to be.  */
+  atomic_uint items;          /* futex the receiver sleeps on.  */
+  unsigned int pad2[13];
+  atomic_uint sending;        /* number of senders asleep, or about to be.  */
+  atomic_uint spaces;         /* futex the senders sleep on.  */
+  unsigned int units;         /* size of the arena in units, a power of two.  */
+  atomic_uint *seq;           /* position each unit is ready to be sent or received at.  */
+  char *arena;
+  struct mailbox_t *prev;     /* previous mailbox.  */
+} mailbox;
+
+
+#if !defined(mailbox_h)
+#  define mailbox_h
+#  if defined(mailbox_c)
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN
+#     endif /* !__GNUG__.  */
+#  else /* !mailbox_c.  */
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN extern
+#     endif /* !__GNUG__.  */
+#  endif /* !mailbox_c.  */
+
+
+/*
+ *  init - create a single mailbox which can contain MAX_MAILBOX_DATA
+ *         triples.
+ */
+
+EXTERN mailbox *mailbox_init (void);
+
+
+/*
+ *  initSize - create a single mailbox with an arena of at least,
+ *             bytes.  The arena is rounded up to a power of two units.
+ */
+
+EXTERN mailbox *mailbox_initSize (unsigned int bytes);
+
+
+/*
+ *  kill - return the mailbox to the freelist.  No process must use this
+ *         mailbox.
+ */
+
+EXTERN mailbox *mailbox_kill (mailbox *mbox);
+
+
+/*
+ *  reserve - claim room in mailbox, mbox, for a message of, type, with
+ *            a payload of, length, bytes, blocking while it is full.
+ *            The address of the payload is returned for the sender to
+ *            fill in before calling commit.  The header and payload
+ *            together must fit in half the arena, a larger message is
+ *            an error.
+ */
+
+EXTERN void *mailbox_reserve (mailbox *mbox, int type, unsigned int length);
+
+
+/*
+ *  commit - deliver the message whose payload, msg, was returned by
+ *           reserve.
+ */
+
+EXTERN void mailbox_commit (mailbox *mbox, void *msg);
+
+
+/*
+ *  receive - return the address of the payload of the oldest message
+ *            in mailbox, mbox, and assign its type and length.  It
+ *            blocks while the mailbox is empty.  The message remains
+ *            in the mailbox until release is called.
+ */
+
+EXTERN void *mailbox_receive (mailbox *mbox, int *type, unsigned int *length);
+
+
+/*
+ *  poll - as receive, but NULL is returned if the mailbox is empty.
+ */
+
+EXTERN void *mailbox_poll (mailbox *mbox, int *type, unsigned int *length);
+
+
+/*
+ *  release - remove the message returned by receive or poll from the
+ *            mailbox, mbox.
+ */
+
+EXTERN void mailbox_release (mailbox *mbox);
+
+
+/*
+ *  send - send (result, move_no, positions_explored) to the mailbox mbox.
+ */
+
+EXTERN void mailbox_send (mailbox *mbox,
+			  int result, int move_no, int positions_explored);
+
+
+/*
+ *  rec - receive (result, move_no, positions_explored) from the
+ *        mailbox mbox.
+ */
+
+EXTERN void mailbox_rec (mailbox *mbox,
+			 int *result, int *move_no,
+			 int *positions_explored);
+
+#  undef EXTERN
+#endif /* !mailbox_h.  */
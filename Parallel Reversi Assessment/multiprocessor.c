@@ -1,125 +1,870 @@
-#include <stdio.h>
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <sys/sysinfo.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <time.h>
-#include <unistd.h>
-
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
-#include <semaphore.h>
-
-
-#if !defined(TRUE)
-#  define TRUE (1==1)
-#endif
-
-#define MAX_SEMAPHORES  1000
-static sem_t *sem_array;
-static unsigned int sem_used;
-
-
-/*
- *  maxProcessors - return the total number of cores available.
- */
-
-int multiprocessor_maxProcessors (void)
-{
-  return get_nprocs ();
-}
-
-
-/*
- *  initSem - initialise and return a new semaphore containing value.
- */
-
-sem_t *multiprocessor_initSem (int value)
-{
-  if (sem_used == MAX_SEMAPHORES)
-    {
-      printf ("MAX_SEMAPHORES has been exceeded\n");
-      exit (1);
-    }
-  sem_t *base_sem = &sem_array[sem_used];
-  sem_used++;
-
-  /* set up semaphore.  */
-  int status = sem_init (base_sem, TRUE, value);
-  return base_sem;
-}
-
-
-/*
- *  wait - block until a token is available in the semaphore.
- */
-
-void multiprocessor_wait (sem_t *base_sem)
-{
-  sem_wait (base_sem);
-}
-
-
-/*
- *  signal - gives a single token to the semaphore.
- */
-
-void multiprocessor_signal (sem_t *base_sem)
-{
-  sem_post (base_sem);
-}
-
-
-void multiprocessor_killSem (sem_t *base_sem)
-{
-  printf ("semaphores cannot be deleted\n");
-  exit (1);
-}
-
-
-/*
- *  initSharedMemory - initialise the shared memory block of memory.
- *                     mem_size determines the size of the block
- *                     the address of the free block of shared memory
- *                     is returned.  As a by product extra shared
- *                     memory is allocated which is used by the semaphore
- *                     data structures.  It allows the user to perform
- *                     a single shared memory allocation and use it for
- *                     multiple objects which is required as semaphores
- *                     also need to be placed in the shared memory region.
- */
-
-void *multiprocessor_initSharedMemory (unsigned int mem_size)
-{
-  void *allocated;
-  key_t segid = ftok (".", 'R');
-  int shmid = shmget (segid, mem_size + MAX_SEMAPHORES * sizeof (sem_t), IPC_CREAT | 0660);
-  if (shmid < 0)
-    {
-      printf ("shmget failed\n");
-      exit (1);
-    }
-  sem_array = (sem_t *) shmat (shmid, (void *)0, 0);
-  allocated = &sem_array[MAX_SEMAPHORES];  /* start of the memory after the semaphores.  */
-  sem_used = 0;
-  return allocated;
-}
-
-
-/* constructor for the module.  */
-
-void _M2_multiprocessor_init (void)
-{
-}
-
-
-/* deconstructor for the module.  */
-
-void _M2_multiprocessor_finish (void)
-{
-  if (sem_array != NULL)
-    shmdt (sem_array);
-}
+#define _GNU_SOURCE  /* for sched_setaffinity and the cpu_set_t macros.  */
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/sysinfo.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <semaphore.h>
+#include <string.h>
+#include <sched.h>
+
+
+#if !defined(TRUE)
+#  define TRUE (1==1)
+#endif
+
+#if !defined(FALSE)
+#  define FALSE (1==0)
+#endif
+
+#define MAX_NODES       64   /* NUMA nodes we can interleave over.  */
+
+#define COMPACT          0   /* affinity policies.  */
+#define SCATTER          1
+
+#define SMALL_PAGES      0   /* how a region is backed.  */
+#define HUGETLB_PAGES    1   /* reserved huge pages, MAP_HUGETLB.  */
+#define THP_PAGES        2   /* transparent huge pages were requested.  */
+
+typedef struct region_t {
+  void *start;
+  size_t size;
+  int pages;                     /* SMALL_PAGES, HUGETLB_PAGES or THP_PAGES.  */
+  struct region_t *next;
+} region;
+
+static sem_t *sem_array;
+static unsigned int sem_used;
+static unsigned int sem_max;     /* semaphores in sem_array.  */
+static int in_process = FALSE;  /* are the users threads of one process?  */
+static region *regions = NULL;   /* every block of shared memory we mapped.  */
+static int use_huge_pages = FALSE;
+static int use_interleave = FALSE;
+static unsigned long node_mask[MAX_NODES / (8 * sizeof (unsigned long))];
+static int no_nodes = 0;         /* NUMA nodes online, 0 until looked up.  */
+static int cpu_order[CPU_SETSIZE];  /* processor each searcher is pinned to.  */
+static int no_pinned = 0;        /* entries in cpu_order, 0 if not pinning.  */
+static int processor_limit = 0;  /* set by setProcessors, 0 if not set.  */
+
+typedef struct processor_t {
+  int cpu;
+  int package;                   /* socket.  */
+  int core;                      /* core within the package.  */
+  int thread;                    /* hyperthread within the core.  */
+} processor;
+
+
+/*
+ *  parseList - assign, list, with the numbers in the string, s, which
+ *              is written as a list of ranges, for example "0-3,6,8".
+ *              At most, max, numbers are assigned and the count is
+ *              returned, or -1 if the string is malformed.
+ */
+
+static int parseList (const char *s, int *list, int max)
+{
+  int first, last, n = 0;
+  char *end;
+
+  while (*s != '\0' && *s != '\n')
+    {
+      first = (int) strtol (s, &end, 10);
+      if (end == s || first < 0)
+	return -1;
+      last = first;
+      s = end;
+      if (*s == '-')
+	{
+	  last = (int) strtol (s + 1, &end, 10);
+	  if (end == s + 1 || last < first)
+	    return -1;
+	  s = end;
+	}
+      for (; first <= last && n < max; first++)
+	list[n++] = first;
+      if (*s == ',')
+	s++;
+      else if (*s != '\0' && *s != '\n')
+	return -1;
+    }
+  return n;
+}
+
+
+/*
+ *  hugePageSize - return the size of the default huge page in bytes.
+ */
+
+static size_t hugePageSize (void)
+{
+  FILE *f = fopen ("/proc/meminfo", "r");
+  char line[256];
+  unsigned long kb = 2048;
+
+  if (f != NULL)
+    {
+      while (fgets (line, sizeof (line), f) != NULL)
+	if (sscanf (line, "Hugepagesize: %lu kB", &kb) == 1)
+	  break;
+      fclose (f);
+    }
+  return (size_t) kb * 1024;
+}
+
+
+/*
+ *  findNodes - fill in node_mask and no_nodes from the list of online
+ *              NUMA nodes, for example "0-1,3".
+ */
+
+static void findNodes (void)
+{
+  FILE *f = fopen ("/sys/devices/system/node/online", "r");
+  char line[256];
+  int nodes[MAX_NODES];
+  int i;
+
+  memset (node_mask, 0, sizeof (node_mask));
+  no_nodes = 0;
+  if (f != NULL)
+    {
+      if (fgets (line, sizeof (line), f) != NULL)
+	no_nodes = parseList (line, nodes, MAX_NODES);
+      fclose (f);
+    }
+  for (i = 0; i < no_nodes; i++)
+    if (nodes[i] < MAX_NODES)
+      node_mask[nodes[i] / (8 * sizeof (unsigned long))]
+	|= 1UL << (nodes[i] % (8 * sizeof (unsigned long)));
+  if (no_nodes <= 0)
+    no_nodes = 1;  /* no NUMA support in the kernel.  */
+}
+
+
+/*
+ *  interleave - ask for the pages of the block at, start, of, size,
+ *               bytes to be spread round robin over every NUMA node.
+ */
+
+static void interleave (void *start, size_t size)
+{
+  if (no_nodes == 0)
+    findNodes ();
+  if (no_nodes > 1)
+    syscall (SYS_mbind, start, size, MPOL_INTERLEAVE,
+	     node_mask, (unsigned long) MAX_NODES + 1, 0);
+}
+
+
+/*
+ *  mapShared - return a new block of, size, bytes of zeroed memory
+ *              which is shared with every child forked afterwards.
+ *              The mapping is anonymous, so it belongs to no file or
+ *              key and disappears with the last process using it.
+ */
+
+static void *mapShared (size_t size)
+{
+  region *r = (region *) malloc (sizeof (region));
+  void *start = MAP_FAILED;
+  size_t huge = hugePageSize ();
+  int pages = SMALL_PAGES;
+
+  if (use_huge_pages && size >= huge)
+    {
+      /* only possible if the administrator has reserved huge pages.  */
+      start = mmap (NULL, (size + huge - 1) / huge * huge, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (start != MAP_FAILED)
+	{
+	  size = (size + huge - 1) / huge * huge;
+	  pages = HUGETLB_PAGES;
+	}
+    }
+  if (start == MAP_FAILED)
+    {
+      start = mmap (NULL, size, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+      if (start != MAP_FAILED && use_huge_pages && size >= huge
+	  && madvise (start, size, MADV_HUGEPAGE) == 0)
+	pages = THP_PAGES;
+    }
+  if (r == NULL || start == MAP_FAILED)
+    {
+      printf ("unable to allocate %lu bytes of shared memory\n",
+	      (unsigned long) size);
+      exit (1);
+    }
+  if (use_interleave)
+    interleave (start, size);
+  if (use_huge_pages || use_interleave)
+    /* touch every page now so that it is placed as asked, rather than
+       on the node of whichever worker happens to touch it first.  */
+    memset (start, 0, size);
+
+  r->start = start;
+  r->size = size;
+  r->pages = pages;
+  r->next = regions;
+  regions = r;
+  return start;
+}
+
+
+/*
+ *  useThreads - all users of the semaphores and shared memory are
+ *               threads within this process, so process private
+ *               semaphores are used instead.  It must be called before
+ *               any other function in this module.
+ */
+
+void multiprocessor_useThreads (void)
+{
+  in_process = TRUE;
+}
+
+
+/*
+ *  useHugePages - back each block of shared memory of at least a huge
+ *                 page with huge pages.  Reserved huge pages are used
+ *                 if there are enough, otherwise transparent huge
+ *                 pages are requested.  It must be called before any
+ *                 shared memory is allocated.
+ */
+
+void multiprocessor_useHugePages (void)
+{
+  use_huge_pages = TRUE;
+}
+
+
+/*
+ *  useInterleave - spread the pages of every block of shared memory
+ *                  evenly over the NUMA nodes.  It must be called
+ *                  before any shared memory is allocated.
+ */
+
+void multiprocessor_useInterleave (void)
+{
+  use_interleave = TRUE;
+}
+
+
+/*
+ *  findRegion - return the region mapped at address, start, or NULL.
+ */
+
+static region *findRegion (unsigned long start)
+{
+  region *r;
+
+  for (r = regions; r != NULL; r = r->next)
+    if ((unsigned long) r->start == start)
+      return r;
+  return NULL;
+}
+
+
+/*
+ *  reportPlacement - display how the shared memory has actually been
+ *                    placed, according to the kernel.  The page sizes
+ *                    and nodes come from /proc/self/numa_maps and the
+ *                    transparent huge pages from /proc/self/smaps.
+ */
+
+void multiprocessor_reportPlacement (void)
+{
+  double node_mb[MAX_NODES];
+  double total = 0.0, hugetlb = 0.0, thp = 0.0;
+  char line[4096];
+  char *p, *end;
+  region *r, *current = NULL;
+  unsigned long kb, page_kb, pages;
+  int n, thp_asked = FALSE;
+  FILE *f;
+
+  for (n = 0; n < MAX_NODES; n++)
+    node_mb[n] = 0.0;
+  for (r = regions; r != NULL; r = r->next)
+    {
+      total += r->size / 1048576.0;
+      if (r->pages == HUGETLB_PAGES)
+	hugetlb += r->size / 1048576.0;
+      if (r->pages == THP_PAGES)
+	thp_asked = TRUE;
+    }
+
+  f = fopen ("/proc/self/numa_maps", "r");
+  if (f != NULL)
+    {
+      while (fgets (line, sizeof (line), f) != NULL)
+	{
+	  if (findRegion (strtoul (line, &end, 16)) == NULL)
+	    continue;
+	  page_kb = 4;
+	  p = strstr (line, "kernelpagesize_kB=");
+	  if (p != NULL)
+	    page_kb = strtoul (p + strlen ("kernelpagesize_kB="), NULL, 10);
+	  for (p = strstr (end, " N"); p != NULL; p = strstr (p + 1, " N"))
+	    if (sscanf (p, " N%d=%lu", &n, &pages) == 2 && n >= 0 && n < MAX_NODES)
+	      node_mb[n] += pages * page_kb / 1024.0;
+	}
+      fclose (f);
+    }
+
+  f = fopen ("/proc/self/smaps", "r");
+  if (f != NULL && thp_asked)
+    while (fgets (line, sizeof (line), f) != NULL)
+      {
+	if (strchr (line, '-') != NULL && strtoul (line, &end, 16) != 0 && *end == '-')
+	  current = findRegion (strtoul (line, NULL, 16));
+	else if (current != NULL && sscanf (line, "ShmemPmdMapped: %lu kB", &kb) == 1)
+	  thp += kb / 1024.0;
+      }
+  if (f != NULL)
+    fclose (f);
+
+  printf ("shared memory of %.1f MB", total);
+  if (use_huge_pages)
+    {
+      if (hugetlb > 0.0 || thp > 0.0)
+	printf (", %.1f MB on huge pages and %.1f MB on transparent huge pages",
+		hugetlb, thp);
+      else
+	printf (", no huge pages were available");
+    }
+  if (use_interleave && no_nodes <= 1)
+    printf (", there is only one NUMA node");
+  for (n = 0; n < MAX_NODES; n++)
+    if (node_mb[n] > 0.0)
+      printf (", %.1f MB on node %d", node_mb[n], n);
+  printf ("\n");
+}
+
+
+/*
+ *  allowed - assign, set, with the processors in our cpuset.  The set
+ *            is read once, before we pin ourselves to a single one.
+ */
+
+static void allowed (cpu_set_t *set)
+{
+  static cpu_set_t cpuset;
+  static int known = FALSE;
+  int i;
+
+  if (! known)
+    {
+      if (sched_getaffinity (0, sizeof (cpuset), &cpuset) != 0)
+	{
+	  CPU_ZERO (&cpuset);
+	  for (i = 0; i < get_nprocs () && i < CPU_SETSIZE; i++)
+	    CPU_SET (i, &cpuset);
+	}
+      known = TRUE;
+    }
+  *set = cpuset;
+}
+
+
+/*
+ *  topology - return the value of the topology attribute, name, of
+ *             processor, cpu, or, unknown, if it cannot be read.
+ */
+
+static int topology (int cpu, const char *name, int unknown)
+{
+  char path[128];
+  FILE *f;
+  int value = unknown;
+
+  snprintf (path, sizeof (path), "/sys/devices/system/cpu/cpu%d/topology/%s",
+	    cpu, name);
+  f = fopen (path, "r");
+  if (f != NULL)
+    {
+      if (fscanf (f, "%d", &value) != 1)
+	value = unknown;
+      fclose (f);
+    }
+  return value;
+}
+
+
+/*
+ *  compactOrder - sort by package, core and then hyperthread, so that
+ *                 consecutive searchers share a core and its caches.
+ */
+
+static int compactOrder (const void *a, const void *b)
+{
+  const processor *p = (const processor *) a;
+  const processor *q = (const processor *) b;
+
+  if (p->package != q->package)
+    return p->package - q->package;
+  if (p->core != q->core)
+    return p->core - q->core;
+  if (p->thread != q->thread)
+    return p->thread - q->thread;
+  return p->cpu - q->cpu;
+}
+
+
+/*
+ *  scatterOrder - sort by hyperthread, core and then package, so that
+ *                 each searcher has a core, and if possible a package,
+ *                 to itself before any core is shared.
+ */
+
+static int scatterOrder (const void *a, const void *b)
+{
+  const processor *p = (const processor *) a;
+  const processor *q = (const processor *) b;
+
+  if (p->thread != q->thread)
+    return p->thread - q->thread;
+  if (p->core != q->core)
+    return p->core - q->core;
+  if (p->package != q->package)
+    return p->package - q->package;
+  return p->cpu - q->cpu;
+}
+
+
+/*
+ *  orderProcessors - fill in cpu_order with every processor in our
+ *                    cpuset sorted according to, policy.
+ */
+
+static void orderProcessors (int policy)
+{
+  processor p[CPU_SETSIZE];
+  cpu_set_t set;
+  int cpu, i, n = 0;
+
+  allowed (&set);
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    if (CPU_ISSET (cpu, &set))
+      {
+	p[n].cpu = cpu;
+	p[n].package = topology (cpu, "physical_package_id", 0);
+	p[n].core = topology (cpu, "core_id", cpu);
+	p[n].thread = 0;
+	for (i = 0; i < n; i++)
+	  if (p[i].package == p[n].package && p[i].core == p[n].core)
+	    p[n].thread++;
+	n++;
+      }
+  qsort (p, n, sizeof (processor), policy == COMPACT ? compactOrder : scatterOrder);
+  for (i = 0; i < n; i++)
+    cpu_order[i] = p[i].cpu;
+  no_pinned = n;
+}
+
+
+/*
+ *  setAffinity - pin the searchers to processors according to, policy,
+ *                which is "compact" (fill the hyperthreads of a core
+ *                first), "scatter" (a core each before any is shared)
+ *                or a list of processors, for example "0,2,4-7".  Only
+ *                processors in our cpuset may be used.
+ */
+
+void multiprocessor_setAffinity (const char *policy)
+{
+  cpu_set_t set;
+  int i;
+
+  if (strcmp (policy, "compact") == 0)
+    orderProcessors (COMPACT);
+  else if (strcmp (policy, "scatter") == 0)
+    orderProcessors (SCATTER);
+  else
+    {
+      no_pinned = parseList (policy, cpu_order, CPU_SETSIZE);
+      if (no_pinned <= 0)
+	{
+	  printf ("affinity must be compact, scatter or a list of processors, not %s\n",
+		  policy);
+	  exit (1);
+	}
+      allowed (&set);
+      for (i = 0; i < no_pinned; i++)
+	if (cpu_order[i] >= CPU_SETSIZE || ! CPU_ISSET (cpu_order[i], &set))
+	  {
+	    printf ("processor %d is not in our cpuset\n", cpu_order[i]);
+	    exit (1);
+	  }
+    }
+}
+
+
+/*
+ *  processorFor - return the processor searcher, n, is pinned to, or
+ *                 -1 if the searchers are not pinned.  The processors
+ *                 are reused in order should there be more searchers.
+ */
+
+int multiprocessor_processorFor (int n)
+{
+  if (no_pinned == 0)
+    return -1;
+  return cpu_order[n % no_pinned];
+}
+
+
+/*
+ *  pin - pin the calling thread or process to the processor chosen for
+ *        searcher, n.  Nothing happens if the searchers are not pinned.
+ */
+
+void multiprocessor_pin (int n)
+{
+  cpu_set_t set;
+  int cpu = multiprocessor_processorFor (n);
+
+  if (cpu < 0)
+    return;
+  CPU_ZERO (&set);
+  CPU_SET (cpu, &set);
+  if (sched_setaffinity (0, sizeof (set), &set) != 0)
+    {
+      printf ("unable to pin searcher %d to processor %d\n", n, cpu);
+      exit (1);
+    }
+}
+
+
+/*
+ *  setProcessors - override the number of processors returned by
+ *                  maxProcessors with, n.
+ */
+
+void multiprocessor_setProcessors (int n)
+{
+  processor_limit = n;
+}
+
+
+/*
+ *  readQuota - return the cpu bandwidth quota, in processors, of the
+ *              cgroup, path, below the hierarchy mounted at, root, or
+ *              of any cgroup above it, whichever is the least.  v2 is
+ *              TRUE for the unified hierarchy (cpu.max) and FALSE for
+ *              the v1 cpu controller (cpu.cfs_quota_us).  0.0 is
+ *              returned if there is no quota.
+ */
+
+static double readQuota (const char *root, const char *path, int v2)
+{
+  char dir[1024], file[1200], line[128];
+  double quota = 0.0, q;
+  long long limit, period;
+  char *slash;
+  FILE *f;
+
+  snprintf (dir, sizeof (dir), "%s", path);
+  for (;;)
+    {
+      q = 0.0;
+      if (v2)
+	{
+	  snprintf (file, sizeof (file), "%s%s/cpu.max", root, dir);
+	  f = fopen (file, "r");
+	  if (f != NULL)
+	    {
+	      /* either "max period" or "limit period" in microseconds */
+	      if (fgets (line, sizeof (line), f) != NULL
+		  && sscanf (line, "%lld %lld", &limit, &period) == 2
+		  && limit > 0 && period > 0)
+		q = (double) limit / period;
+	      fclose (f);
+	    }
+	}
+      else
+	{
+	  limit = -1;
+	  period = 0;
+	  snprintf (file, sizeof (file), "%s%s/cpu.cfs_quota_us", root, dir);
+	  f = fopen (file, "r");
+	  if (f != NULL)
+	    {
+	      if (fscanf (f, "%lld", &limit) != 1)
+		limit = -1;
+	      fclose (f);
+	    }
+	  snprintf (file, sizeof (file), "%s%s/cpu.cfs_period_us", root, dir);
+	  f = fopen (file, "r");
+	  if (f != NULL)
+	    {
+	      if (fscanf (f, "%lld", &period) != 1)
+		period = 0;
+	      fclose (f);
+	    }
+	  if (limit > 0 && period > 0)
+	    q = (double) limit / period;
+	}
+      if (q > 0.0 && (quota == 0.0 || q < quota))
+	quota = q;
+
+      /* move up to the parent cgroup, the root has no quota */
+      slash = strrchr (dir, '/');
+      if (slash == NULL || slash == dir)
+	break;
+      *slash = '\0';
+    }
+  return quota;
+}
+
+
+/*
+ *  cgroupQuota - return the cpu bandwidth quota of our cgroups in
+ *                processors, or 0.0 if there is none.  Both the v1 cpu
+ *                controller and the v2 unified hierarchy are examined,
+ *                as either or both may be mounted.
+ */
+
+static double cgroupQuota (void)
+{
+  FILE *f = fopen ("/proc/self/cgroup", "r");
+  char line[1024], root[1024];
+  char *controllers, *path, *c;
+  double quota = 0.0, q;
+  int v2;
+
+  if (f == NULL)
+    return 0.0;
+  while (fgets (line, sizeof (line), f) != NULL)
+    {
+      /* each line is "hierarchy-id:controllers:path" */
+      controllers = strchr (line, ':');
+      if (controllers == NULL)
+	continue;
+      controllers++;
+      path = strchr (controllers, ':');
+      if (path == NULL)
+	continue;
+      *path++ = '\0';
+      c = strchr (path, '\n');
+      if (c != NULL)
+	*c = '\0';
+      if (strcmp (path, "/") == 0)
+	path = "";
+
+      v2 = (*controllers == '\0');
+      q = 0.0;
+      if (v2)
+	{
+	  q = readQuota ("/sys/fs/cgroup", path, TRUE);
+	  if (q == 0.0)
+	    q = readQuota ("/sys/fs/cgroup/unified", path, TRUE);
+	}
+      else
+	{
+	  /* the hierarchy is mounted under the names of its controllers,
+	     for example /sys/fs/cgroup/cpu,cpuacct */
+	  snprintf (root, sizeof (root), "/sys/fs/cgroup/%s", controllers);
+	  for (c = strtok (controllers, ","); c != NULL; c = strtok (NULL, ","))
+	    if (strcmp (c, "cpu") == 0)
+	      break;
+	  if (c != NULL)
+	    {
+	      q = readQuota (root, path, FALSE);
+	      if (q == 0.0)
+		q = readQuota ("/sys/fs/cgroup/cpu", path, FALSE);
+	    }
+	}
+      if (q > 0.0 && (quota == 0.0 || q < quota))
+	quota = q;
+    }
+  fclose (f);
+  return quota;
+}
+
+
+/*
+ *  cpusetProcessors - return the number of processors in our cpuset,
+ *                     or chosen by setAffinity.
+ */
+
+static int cpusetProcessors (void)
+{
+  cpu_set_t set;
+
+  if (no_pinned > 0)
+    return no_pinned;
+  allowed (&set);
+  return CPU_COUNT (&set);
+}
+
+
+/*
+ *  maxProcessors - return the number of processors we may run on.
+ *                  This is the number given to setProcessors, if it
+ *                  was called, otherwise the least of the processors in
+ *                  our cpuset (or chosen by setAffinity) and our cgroup
+ *                  cpu quota rounded up.
+ */
+
+int multiprocessor_maxProcessors (void)
+{
+  static double quota = -1.0;
+  int n;
+
+  if (processor_limit > 0)
+    return processor_limit;
+  if (quota < 0.0)
+    quota = cgroupQuota ();
+  n = cpusetProcessors ();
+  if (quota > 0.0 && (int) (quota + 0.999) < n)
+    n = (int) (quota + 0.999);
+  if (n < 1)
+    n = 1;
+  return n;
+}
+
+
+/*
+ *  reportProcessors - display the number of processors returned by
+ *                     maxProcessors and how it was decided.
+ */
+
+void multiprocessor_reportProcessors (void)
+{
+  double quota = cgroupQuota ();
+
+  printf ("parallelism of %d: %d processor%s in our cpuset",
+	  multiprocessor_maxProcessors (), cpusetProcessors (),
+	  cpusetProcessors () == 1 ? "" : "s");
+  if (quota > 0.0)
+    printf (", a cgroup cpu quota of %.2f processors", quota);
+  else
+    printf (", no cgroup cpu quota");
+  if (processor_limit > 0)
+    printf (", overridden to %d", processor_limit);
+  printf ("\n");
+}
+
+
+/*
+ *  initSem - initialise and return a new semaphore containing value.
+ */
+
+sem_t *multiprocessor_initSem (int value)
+{
+  if (sem_used == sem_max)
+    {
+      printf ("all %u semaphores requested by initSharedMemory are in use\n",
+	      sem_max);
+      exit (1);
+    }
+  sem_t *base_sem = &sem_array[sem_used];
+  sem_used++;
+
+  /* set up semaphore.  */
+  int status = sem_init (base_sem, ! in_process, value);
+  return base_sem;
+}
+
+
+/*
+ *  wait - block until a token is available in the semaphore.
+ */
+
+void multiprocessor_wait (sem_t *base_sem)
+{
+  sem_wait (base_sem);
+}
+
+
+/*
+ *  signal - gives a single token to the semaphore.
+ */
+
+void multiprocessor_signal (sem_t *base_sem)
+{
+  sem_post (base_sem);
+}
+
+
+void multiprocessor_killSem (sem_t *base_sem)
+{
+  printf ("semaphores cannot be deleted\n");
+  exit (1);
+}
+
+
+/*
+ *  initSharedMemory - initialise the shared memory block of memory.
+ *                     mem_size determines the size of the block
+ *                     the address of the free block of shared memory
+ *                     is returned.  As a by product extra shared
+ *                     memory is allocated for, no_semaphores, semaphore
+ *                     data structures.  It allows the user to perform
+ *                     a single shared memory allocation and use it for
+ *                     multiple objects which is required as semaphores
+ *                     also need to be placed in the shared memory region.
+ */
+
+void *multiprocessor_initSharedMemory (size_t mem_size, unsigned int no_semaphores)
+{
+  sem_array = (sem_t *) mapShared (no_semaphores * sizeof (sem_t) + mem_size);
+  sem_used = 0;
+  sem_max = no_semaphores;
+  return &sem_array[no_semaphores];  /* start of the memory after the semaphores.  */
+}
+
+
+/*
+ *  allocSharedMemory - allocate a further block of shared memory of
+ *                      mem_size bytes which is independent of the
+ *                      semaphore region.  The block is inherited by
+ *                      children forked afterwards.
+ */
+
+void *multiprocessor_allocSharedMemory (size_t mem_size)
+{
+  return mapShared (mem_size);
+}
+
+
+/* constructor for the module.  */
+
+void _M2_multiprocessor_init (void)
+{
+}
+
+
+/* deconstructor for the module.  It destroys the semaphores and
+   unmaps all of the shared memory, so it must only be called once
+   every other user has finished.  */
+
+void _M2_multiprocessor_finish (void)
+{
+  region *r;
+  unsigned int i;
+
+  for (i = 0; i < sem_used; i++)
+    sem_destroy (&sem_array[i]);
+  sem_array = NULL;
+  sem_used = 0;
+  sem_max = 0;
+  while (regions != NULL)
+    {
+      r = regions;
+      regions = r->next;
+      munmap (r->start, r->size);
+      free (r);
+    }
+}
@@ -1,89 +1,186 @@
-/*  multiprocessor.h provides a simple method for using semaphores.
- *  Gaius Mulley <gaius.southwales@gmail.com>.
- */
-
-#if !defined(multiprocessor_h)
-#  define multiprocessor_h
-#  if defined(multiprocessor_c)
-#     if defined(__GNUG__)
-#        define EXTERN extern "C"
-#     else /* !__GNUG__.  */
-#        define EXTERN
-#     endif /* !__GNUG__.  */
-#  else /* !multiprocessor_c.  */
-#     if defined(__GNUG__)
-#        define EXTERN extern "C"
-#     else /* !__GNUG__.  */
-#        define EXTERN extern
-#     endif /* !__GNUG__.  */
-#  endif /* !multiprocessor_c.  */
-
-#include <stdio.h>
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <sys/sysinfo.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <time.h>
-#include <unistd.h>
-
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
-#include <semaphore.h>
-
-/*
- *  maxProcessors - return the total number of cores available.
- */
-
-EXTERN int multiprocessor_maxProcessors (void);
-
-
-/*
- *  initSem - initialise and return a new semaphore containing value.
- */
-
-EXTERN sem_t *multiprocessor_initSem (int value);
-
-
-/*
- *  wait - block until a token is available in the semaphore.
- */
-
-EXTERN void multiprocessor_wait (sem_t *base_sem);
-
-
-/*
- *  signal - gives a single token to the semaphore.
- */
-
-EXTERN void multiprocessor_signal (sem_t *base_sem);
-
-
-/*
- *  initSharedMemory - initialise the shared memory block of memory.
- *                     mem_size determines the size of the block
- *                     the address of the free block of shared memory
- *                     is returned.  As a by product extra shared
- *                     memory is allocated which is used by the semaphore
- *                     data structures.  It allows the user to perform
- *                     a single shared memory allocation and use it for
- *                     multiple objects which is required as semaphores
- *                     also need to be placed in the shared memory region.
- */
-
-EXTERN void *multiprocessor_initSharedMemory (unsigned int mem_size);
-
-
-/* constructor for the library.  */
-
-EXTERN void _M2_multiprocessor_init (void);
-
-
-/* deconstructor for the library.  */
-
-EXTERN void _M2_multiprocessor_finish (void);
-
-#  undef EXTERN
-#endif /* !multiprocessor_h.  */
+/*  multiprocessor.h provides a simple method for using semaphores.
+ *  Gaius Mulley <gaius.southwales@gmail.com>.
+ */
+
+#if !defined(multiprocessor_h)
+#  define multiprocessor_h
+#  if defined(multiprocessor_c)
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN
+#     endif /* !__GNUG__.  */
+#  else /* !multiprocessor_c.  */
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN extern
+#     endif /* !__GNUG__.  */
+#  endif /* !multiprocessor_c.  */
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/sysinfo.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <semaphore.h>
+
+/*
+ *  useThreads - all users of the semaphores and shared memory are
+ *               threads within this process, so process private
+ *               semaphores are used instead.  It must be called before
+ *               any other function in this module.
+ */
+
+EXTERN void multiprocessor_useThreads (void);
+
+
+/*
+ *  useHugePages - back each block of shared memory of at least a huge
+ *                 page with huge pages.  Reserved huge pages are used
+ *                 if there are enough, otherwise transparent huge
+ *                 pages are requested.  It must be called before any
+ *                 shared memory is allocated.
+ */
+
+EXTERN void multiprocessor_useHugePages (void);
+
+
+/*
+ *  useInterleave - spread the pages of every block of shared memory
+ *                  evenly over the NUMA nodes.  It must be called
+ *                  before any shared memory is allocated.
+ */
+
+EXTERN void multiprocessor_useInterleave (void);
+
+
+/*
+ *  reportPlacement - display how the shared memory has actually been
+ *                    placed, according to the kernel.
+ */
+
+EXTERN void multiprocessor_reportPlacement (void);
+
+
+/*
+ *  setAffinity - pin the searchers to processors according to, policy,
+ *                which is "compact" (fill the hyperthreads of a core
+ *                first), "scatter" (a core each before any is shared)
+ *                or a list of processors, for example "0,2,4-7".  Only
+ *                processors in our cpuset may be used.
+ */
+
+EXTERN void multiprocessor_setAffinity (const char *policy);
+
+
+/*
+ *  processorFor - return the processor searcher, n, is pinned to, or
+ *                 -1 if the searchers are not pinned.  The processors
+ *                 are reused in order should there be more searchers.
+ */
+
+EXTERN int multiprocessor_processorFor (int n);
+
+
+/*
+ *  pin - pin the calling thread or process to the processor chosen for
+ *        searcher, n.  Nothing happens if the searchers are not pinned.
+ */
+
+EXTERN void multiprocessor_pin (int n);
+
+
+/*
+ *  setProcessors - override the number of processors returned by
+ *                  maxProcessors with, n.
+ */
+
+EXTERN void multiprocessor_setProcessors (int n);
+
+
+/*
+ *  maxProcessors - return the number of processors we may run on.
+ *                  This is the number given to setProcessors, if it
+ *                  was called, otherwise the least of the processors in
+ *                  our cpuset (or chosen by setAffinity) and our cgroup
+ *                  cpu quota rounded up.
+ */
+
+EXTERN int multiprocessor_maxProcessors (void);
+
+
+/*
+ *  reportProcessors - display the number of processors returned by
+ *                     maxProcessors and how it was decided.
+ */
+
+EXTERN void multiprocessor_reportProcessors (void);
+
+
+/*
+ *  initSem - initialise and return a new semaphore containing value.
+ */
+
+EXTERN sem_t *multiprocessor_initSem (int value);
+
+
+/*
+ *  wait - block until a token is available in the semaphore.
+ */
+
+EXTERN void multiprocessor_wait (sem_t *base_sem);
+
+
+/*
+ *  signal - gives a single token to the semaphore.
+ */
+
+EXTERN void multiprocessor_signal (sem_t *base_sem);
+
+
+/*
+ *  initSharedMemory - initialise the shared memory block of memory.
+ *                     mem_size determines the size of the block
+ *                     the address of the free block of shared memory
+ *                     is returned.  As a by product extra shared
+ *                     memory is allocated for, no_semaphores, semaphore
+ *                     data structures.  It allows the user to perform
+ *                     a single shared memory allocation and use it for
+ *                     multiple objects which is required as semaphores
+ *                     also need to be placed in the shared memory region.
+ */
+
+EXTERN void *multiprocessor_initSharedMemory (size_t mem_size,
+					      unsigned int no_semaphores);
+
+
+/*
+ *  allocSharedMemory - allocate a further block of shared memory of
+ *                      mem_size bytes which is independent of the
+ *                      semaphore region.  The block is inherited by
+ *                      children forked afterwards.
+ */
+
+EXTERN void *multiprocessor_allocSharedMemory (size_t mem_size);
+
+
+/* constructor for the library.  */
+
+EXTERN void _M2_multiprocessor_init (void);
+
+
+/* deconstructor for the library, it destroys every semaphore and
+   block of shared memory.  */
+
+EXTERN void _M2_multiprocessor_finish (void);
+
+#  undef EXTERN
+#endif /* !multiprocessor_h.  */
@@ -1,893 +1,2677 @@
-/* Copyright (C) 2007-2021
- * Free Software Foundation, Inc.
- *
- *  Gaius Mulley <gaius@glam.ac.uk> wrote Tiny Othello.
- */
-
-/*
-This file is part of GNU Tiny Othello
-
-GNU Tiny Othello is free software; you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation; either version 2, or (at your option)
-any later version.
-
-GNU Tiny Othello is distributed in the hope that it will be useful,
-but WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-GNU General Public License for more details.
-
-You should have received a copy of the GNU General Public License
-along with Tiny Othello; see the file COPYING.  If not, write to the
-Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
-02110-1301, USA.
-*/
-
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-
-#if !defined(SEQUENTIAL)
-#  include "multiprocessor.h"
-#  include "mailbox.h"
-#endif
-
-#if !defined(TRUE)
-#  define TRUE (1==1)
-#endif
-
-#if !defined(FALSE)
-#  define FALSE (1==0)
-#endif
-
-
-#define MAXX                         8
-#define MAXY                         8
-#define MAXPOS                       (MAXX*MAXY)
-#define IS_OUR_COLOUR(COLOUR,USED,BIT,COL)  \
-                                     (IN((USED),(BIT)) && (IN((COLOUR),(BIT)) == (COL)))
-#define GET_COLOUR(COLOUR,BIT)       (IN((COLOUR),(BIT)))
-#define UN_USED(SET,BIT)             (IN((SET),(BIT)) == 0)
-#define IS_USED(SET,BIT)             (IN((SET),(BIT)) == 1)
-#define LEFT_EDGE(BIT)               ((BIT) & (~7))
-#define RIGHT_EDGE(BIT)              ((BIT) | 7)
-#define TOP_EDGE(BIT)                ((BIT) | (32+16+8))
-#define BOT_EDGE(BIT)                ((BIT) & (~(32+16+8)))
-
-#define ASSERT(X)                    do { if (!(X)) { fprintf(stderr, "%s:%d: assert failed\n", __FILE__, __LINE__); exit(1); } } while (0);
-
-#define INITIALPLY          6
-#define MAXPLY             14
-#define MAXMOVES           60
-
-#undef USE_CORNER_SCORES
-
-#if defined(USE_CORNER_SCORES)
-#  define CORNERVAL       (64*4)
-#  define PIECEVAL           64
-
-#  define MAXSCORE           (64*64*64)
-#  define MINSCORE          -(64*64*64)
-#else
-#  define CORNERVAL           0
-#  define PIECEVAL            1
-
-#  define MAXSCORE           64
-#  define MINSCORE          -64
-#endif
-
-
-#define WINSCORE       (64*PIECEVAL)
-#define LOOSESCORE    (-64*PIECEVAL)
-
-#define AmountOfTime        1      /* seconds */
-#define WHITE               1
-#define BLACK               0
-
-typedef unsigned long long BITSET64;
-
-static BITSET64 Colours;
-static BITSET64 Used;
-static int noPlies = INITIALPLY;
-static int timePerMove = 10;
-static int positionsExplored;  /* no of positions evaluated in the current move.  */
-
-#if 0
-static int bestMove[MAXPLY+1];
-static int bestMoveDepth;
-static int currentMove[MAXPLY+1];
-static int currentDepth;
-#endif
-
-
-/*
- *  IN - return 1 or 0 depending whether, bit, is in, set.
- */
-
-static __inline__ int IN (BITSET64 set, int bit)
-{
-  if (sizeof(BITSET64) > sizeof(unsigned int)) {
-    unsigned int *p = (unsigned int *)&set;
-
-    if (bit >= sizeof(unsigned int)*8)
-      /* high unsigned int */
-      return (p[1] >> (bit-(sizeof(unsigned int)*8))) & 1;
-    else
-      /* low */
-      return (p[0] >> bit) & 1;
-  }
-  else
-    return (set >> bit) & 1;
-}
-
-/*
- *  INCL - set, bit, in, set.
- */
-
-static __inline__ void INCL (BITSET64 *set, int bit)
-{
-  if (sizeof(BITSET64) > sizeof(unsigned int)) {
-    unsigned int *p = (unsigned int *)set;
-
-    if (bit >= sizeof(unsigned int)*8)
-      /* high unsigned int */
-      p[1] |= 1 << (bit-(sizeof(unsigned int)*8));
-    else
-      /* low */
-      p[0] |= 1 << bit;
-  }
-  else
-    (*set) |= 1 << bit;
-}
-
-/*
- *  EXCL - unset, bit, in, set.
- */
-
-static __inline__ void EXCL (BITSET64 *set, int bit)
-{
-  if (sizeof(BITSET64) > sizeof(unsigned int)) {
-    unsigned int *p = (unsigned int *)set;
-
-    if (bit >= sizeof(unsigned int)*8)
-      /* high unsigned int */
-      p[1] &= ~(1 << (bit-(sizeof(unsigned int)*8)));
-    else
-      /* low */
-      p[0] &= ~(1 << bit);
-  }
-  else
-    (*set) &= ~(1 << bit);
-}
-
-static __inline__ int scan (BITSET64 c, BITSET64 u, int p, int our_colour, int o,
-			    int increment, int final,
-			    BITSET64 *newc, BITSET64 *newu)
-{
-  int n = 0;
-  int i;
-
-  if (p != final) {
-    for (i = p+increment; (i != final) && (IS_USED(u, i) && (GET_COLOUR(c, i) == o)); i += increment)
-      n++;
-
-    if ((IS_USED(u, i) && (GET_COLOUR(c, i) == our_colour))) {
-      INCL(newu, p);
-      if (our_colour == WHITE)
-	INCL(newc, p);
-      else
-	EXCL(newc, p);
-      for (i = p+increment; (i != final) && (IS_USED(u, i) && (GET_COLOUR(c, i) == o)); i += increment) {
-	INCL(newu, i);
-	if (our_colour == WHITE)
-	  INCL(newc, i);
-	else
-	  EXCL(newc, i);
-      }
-
-      return n;
-    }
-  }
-  return 0;
-}
-
-static __inline__ int makeMove (BITSET64 c, BITSET64 u, int p, int our_colour,
-				BITSET64 *m, BITSET64 *newc, BITSET64 *newu)
-{
-  int o = 1-our_colour;
-
-  *newc = c;
-  *newu = u;
-  if (UN_USED(u, p)) {
-    int n;
-    int x = p % MAXX;
-    int y = p / MAXY;
-
-    n = scan (c, u, p, our_colour, o, 1, RIGHT_EDGE(p), newc, newu);  /* right */
-    n += scan (c, u, p, our_colour, o, -1, LEFT_EDGE(p), newc, newu);  /* left */
-    n += scan (c, u, p, our_colour, o, MAXX, TOP_EDGE(p), newc, newu);  /* up */
-    n += scan (c, u, p, our_colour, o, -MAXX, BOT_EDGE(p), newc, newu);  /* down */
-
-    if (x>0 && y>0) { /* diag left down */
-      int l;
-      if (x > y)
-	l = x-y;
-      else
-	l = (y-x) * MAXY;
-      n += scan (c, u, p, our_colour, o, -(MAXX+1), l, newc, newu);
-    }
-
-    if (x<MAXX && y<MAXY) {  /* diag right up */
-      int l;
-      if (x > y)
-	l = (MAXX-x+y)*MAXY-1;
-      else
-	l = ((MAXY-1)-y+x) + (MAXY-1)*MAXY;
-      n += scan(c, u, p, our_colour, o, +(MAXX+1), l, newc, newu);
-    }
-
-    if (x>0 && y<MAXY) {  /* diag left up */
-      int l;
-      if (x >= MAXY-y)
-	l = (MAXY-1)*8+(x-(MAXY-1-y));
-      else
-	l = (y+x)*MAXY;
-      n += scan(c, u, p, our_colour, o, +(MAXX-1), l, newc, newu);
-    }
-
-    if (x<MAXX && y>0) {  /* diag right down */
-      int l;
-      if (y >= MAXX-x)
-	l = (y-(MAXX-x-1))*MAXY+MAXX-1;
-      else
-	l = x+y;
-      n += scan(c, u, p, our_colour, o, -(MAXX-1), l, newc, newu);
-    }
-
-    if (n > 0)
-      INCL(m, p);
-
-    return n;
-  }
-  return 0;
-}
-
-
-static void setup (void)
-{
-  INCL(&Used, 35);
-  INCL(&Colours, 35);
-  INCL(&Used, 36);
-  INCL(&Used, 27);
-  INCL(&Used, 28);
-  INCL(&Colours, 28);
-}
-
-
-static void setupTest (void)
-{
-  int i;
-
-  for (i=49; i<=54; i++) {
-    INCL(&Used, i);
-    if (i % 2 == 0)
-      INCL(&Colours, i);
-  }
-  INCL(&Used, 48);
-  INCL(&Used, 40);
-  INCL(&Used, 57);
-  INCL(&Used, 58);
-  INCL(&Colours, 49);
-  INCL(&Colours, 21);
-
-  for (i=41; i<=46; i++) {
-    INCL(&Used, i);
-    if (i % 2 == 1)
-      INCL(&Colours, i);
-  }
-  for (i=33; i<=38; i++) {
-    INCL(&Used, i);
-    if (i % 2 == 0)
-      INCL(&Colours, i);
-  }
-  for (i=0; i<=55; i++) {
-    INCL(&Used, i);
-    if (i % 2 == 1)
-      INCL(&Colours, i);
-  }
-}
-
-
-static void displayBoard (BITSET64 c, BITSET64 u, BITSET64 h, int hint)
-{
-  int i, j;
-  int pos;
-
-  printf("\n================================\n") ;
-  j=0;
-  for (j=MAXY-1; j>=0; j--) {
-    printf(" %d ", j+1);
-    for (i=0; i<MAXX; i++) {
-      pos = j*MAXY+i;
-      if (IS_USED(u, pos)) {
-	if (IS_OUR_COLOUR(c, u, pos, WHITE))
-	  printf(" W ");
-	else
-	  printf(" B ");
-      }
-      else if (hint && (IN(h, pos)))
-	printf(" @ ");
-      else
-	printf(" . ");
-    }
-    printf("\n");
-  }
-  printf("\n");
-  printf("    a  b  c  d  e  f  g  h\n");
-}
-
-
-static int enterMove (void)
-{
-  char ch;
-  int pos;
-
-  printf("enter your move: ");
-  pos = 0;
-  ch = getchar();
-  if (ch == '?') {
-    ch = getchar();
-    return -1;
-  }
-  do {
-    if ((ch>='a') && (ch<='h')) {
-      pos = pos + (int) (ch - 'a');
-    }
-    ch = getchar();
-    if ((ch>='1') && (ch<='8')) {
-      pos = (pos + ((int) (ch-'1'))*MAXY) % (MAXY*MAXX);
-    }
-    ch = getchar();
-  } while ((pos < 0) && (pos > (MAXX*MAXY-1))) ;
-  printf("entered %d\n", pos);
-  return pos;
-}
-
-
-#if 0
-  /*       R   L   U   D  LD RU  LU  RD */
-  makeMove(Colours, Used, 21, 1, NULL, NULL,
-	   23, 16, 61, 5, 3, 39, 56, 7);
-
-  makeMove(Colours, Used, 30, 1, NULL, NULL,
-	   31, 24, 62, 6, 3, 39, 58, 23);
-
-  makeMove(Colours, Used, 43, 1, NULL, NULL,
-	   47, 40, 59, 3, 16, 61, 57, 15);
-
-  makeMove(Colours, Used, 18, 1, NULL, NULL,
-	   23, 16, 58, 2, 0, 63, 32, 4);
-
-  makeMove(Colours, Used, 45, 1, NULL, NULL,
-	   47, 40, 61, 5, 0, 63, 59, 31);
-
-  makeMove(Colours, Used, 50, 1, NULL, NULL,
-	   55, 48, 58, 2, 32, 59, 57, 15);
-
-  makeMove(Colours, Used, 24, 1, NULL, NULL,
-	   31, 24, 56, 0, 24, 60, 24, 3);
-#endif
-
-
-/*
- *  max - returns the greatest value from, x or y.
- */
-
-static int max (int x, int y)
-{
-  if (x > y)
-    return x;
-  else
-    return y;
-}
-
-/*
- *  min - returns the smallest value from, x or y.
- */
-
-static int min (int x, int y)
-{
-  if (x < y)
-    return x;
-  else
-    return y;
-}
-
-/*
- *  evaluate - returns a measure of goodness for the current board
- *             position. A positive value indicates a good move for
- *             white and a negative value means a good move for black.
- */
-
-static int evaluate (BITSET64 c, BITSET64 u, int final)
-{
-  int score = 0;
-  int used = 0;
-  int i;
-
-  positionsExplored++;
-  for (i=0; i<MAXPOS; i++) {
-    if (IS_USED(u, i)) {
-      used++;
-      if (GET_COLOUR(c, i) == WHITE)
-	score += PIECEVAL;
-      else
-	score -= PIECEVAL;
-    }
-  }
-
-  if (used == MAXPOS || final) {
-    if (score > 0)
-      return MAXSCORE;
-    if (score < 0)
-      return MINSCORE;
-  }
-
-  if (IS_USED(u, 0)) {
-    /* bottom left corner */
-    if (GET_COLOUR(c, 0) == WHITE)
-      score += CORNERVAL;
-    else
-      score -= CORNERVAL;
-  }
-
-  if (IS_USED(u, 7)) {
-    /* bottom right corner */
-    if (GET_COLOUR(c, 7) == WHITE)
-      score += CORNERVAL;
-    else
-      score -= CORNERVAL;
-  }
-
-  if (IS_USED(u, 56)) {
-    /* top left corner */
-    if (GET_COLOUR(c, 56) == WHITE)
-      score += CORNERVAL;
-    else
-      score -= CORNERVAL;
-  }
-
-  if (IS_USED(u, 63)) {
-    /* top right corner */
-    if (GET_COLOUR(c, 63) == WHITE)
-      score += CORNERVAL;
-    else
-      score -= CORNERVAL;
-  }
-
-  return score;
-}
-
-/*
- *  countCounters - returns the number of used positions.
- */
-
-static int countCounters (BITSET64 u)
-{
-  int count=0;
-  int i;
-
-  for (i=0; i<MAXPOS; i++)
-    if (IN(u, i))
-      count++;
-  return count;
-}
-
-/*
- *  findPossible - returns the number of legal moves found.
- *                 These are also assigned to the bitset, m.
- */
-
-static int findPossible (BITSET64 Colours, BITSET64 Used, int o, BITSET64 *m, int l[])
-{
-  int n, p, i;
-  BITSET64 nc, nu;
-
-  n = 0;
-  for (p = 0; p<MAXPOS; p++) {
-    i = makeMove(Colours, Used, p, o, m, &nc, &nu);
-    if (i > 0) {
-      /* printf("legal position %d\n", p); */
-      INCL(m, p);
-      if (l != NULL)
-	l[n] = p;
-      n++;
-    }
-  }
-  return n;
-}
-
-/*
- *  doMove - keep requesting user for a legal move.
- */
-
-static int doMove (BITSET64 c, BITSET64 u, BITSET64 m, int o)
-{
-  int p;
-
-  do {
-    do {
-      if (o == WHITE)
-	printf("white ");
-      else
-	printf("black ");
-      p = enterMove();
-      if (p == -1)
-	displayBoard(c, u, m, TRUE);
-    } while (p == -1);
-    if (! IN(m, p))
-      printf("illegal move\n");
-  } while (! IN(m, p));
-  return p;
-}
-
-/*
- *  humanMove - asks player to enter a legal move and updates the
- *              board.
- */
-
-static int humanMove (BITSET64 c, BITSET64 u, int o)
-{
-  BITSET64 m = 0;
-  BITSET64 nc, nu;
-  int l[MAXMOVES];
-  int n = findPossible(c, u, o, &m, l);
-  int p;
-
-  displayBoard(c, u, m, FALSE);
-
-  if (countCounters(u) == MAXPOS)
-    return FALSE;
-
-  if (n == 0) {
-    printf("you cannot move...\n");
-    return FALSE;
-  }
-  if (n == 1) {
-    p = l[0];
-    printf("you are forced to play the only move available which is %c%d\n",
-	   ((char)(p % MAXX))+'a', p / MAXY+1);
-  } else
-    p = doMove(c, u, m, o);
-
-  n = makeMove(c, u, p, o, &m, &nc, &nu);
-  Colours = nc;
-  Used = nu;
-  return TRUE;
-}
-
-/*
- *  alphaBeta - returns the score estimated should move, p, be chosen.
- *              The board, c, u, is in the state _before_ move p is made.
- *              o is the colour who is attempting to play move, p.
- */
-
-static int alphaBeta (int p, BITSET64 c, BITSET64 u, int depth, int o,
-		      int alpha, int beta)
-{
-  BITSET64 m, nc, nu;
-  int n, try;
-
-  if (p == -1) {
-    /* no move was possible */
-    nc = c;
-    nu = u;
-  }
-  else
-    n = makeMove(c, u, p, o, &m, &nc, &nu);
-
-  o = 1-o;
-  if (depth == 0)
-    return evaluate(c, u, FALSE);
-  else {
-    int l[MAXMOVES];
-    int n = findPossible(nc, nu, o, &m, l);
-    int i;
-
-    if (n == 0) {
-      if (p == -1)
-	return evaluate(nc, nu, TRUE);
-      else
-	/* o, forfits a go and 1-o plays a move instead */
-	return alphaBeta(-1, nc, nu, depth, 1-o, alpha, beta);
-    }
-    else if (o == WHITE) {
-      /* white to move, move is possible, continue searching */
-      for (i=0; i<n; i++) {
-	try = alphaBeta(l[i], nc, nu, depth-1, WHITE, alpha, beta);
-	if (try > alpha)
-	  /* found a better move */
-	  alpha = try;
-	if (alpha >= beta)
-	  return alpha;
-      }
-      return alpha;  /* the best score for a move WHITE has found */
-    }
-    else {
-      /* black to move, move is possible, continue searching */
-      for (i=0; i<n; i++) {
-	try = alphaBeta(l[i], nc, nu, depth-1, BLACK, alpha, beta);
-	if (try < beta)
-	  /* found a better move */
-	  beta = try;
-	if (alpha >= beta)
-	  return beta;  /* no point searching further as WHITE would choose
-			   a different previous move */
-      }
-      return beta;  /* the best score for a move BLACK has found */
-    }
-  }
-}
-
-/*
- *  finalScore - returns the final score.
- */
-
-static int finalScore (BITSET64 c, BITSET64 u)
-{
-  int score=0;
-  int i;
-
-  for (i=0; i<MAXPOS; i++) {
-    if (IS_USED(u, i)) {
-      if (GET_COLOUR(c, i) == WHITE)
-	score++;
-      else
-	score--;
-    }
-  }
-  return score;
-}
-
-#if 0
-/*
- *  displayBestMoves - dumps the anticipated move sequence
- */
-
-static void displayBestMoves (int depth, int o)
-{
-  int i;
-
-  printf("I'm anticipating the move sequence:\n");
-  for (i=depth; i>=0; i--) {
-    if (o == WHITE)
-      printf("white ");
-    else
-      printf("black ");
-    o = 1-o;
-    if (bestMove[i] != -1)
-      printf("%c%d\n",
-	     (char)(bestMove[i] % MAXX)+'a', bestMove[i] / MAXY+1);
-  }
-}
-#endif
-
-static mailbox *barrier;
-static sem_t *processorAvailable;
-
-void setupIPC (void)
-{
-  barrier = mailbox_init ();
-  processorAvailable = multiprocessor_initSem (multiprocessor_maxProcessors ());
-}
-
-
-#if !defined(SEQUENTIAL)
-int parallelSearch (int *totalExplored, int *move,
-		    int best, int *l, int noOfMoves,
-		    BITSET64 c, BITSET64 u, int noPlies, int o, int minscore, int maxscore)
-{
-    // My code
-    int pid = fork();
-    if (pid == 0)
-    {
-        /* Child is the source which spawns each move on a separate core */
-        int i, currentMove;
-        for (i = 0; i < noOfMoves; i++) /* i in no of moves */
-        {
-            multiprocessor_wait(processorAvailable); /* wait for a processor to become available */
-            /* spawn a child process */
-            if (fork() == 0)
-            {
-                /* child must search move i */
-                currentMove = alphaBeta(l[i], c, u, noPlies, o, minscore, maxscore); /* search best move using alphabeta could take many minutes hence parallel */
-
-                mailbox_send(barrier, currentMove, i, positionsExplored); /* need to send move back to parent using mailbox_send */
-
-                multiprocessor_signal(processorAvailable); /* signal that a processor is available */
-                exit();
-            }
-        }
-        exit();
-    }
-    else
-    {
-        /* parent is the sink, which waits for any move to be returned and remembers the best move score */
-        int i, move_score, move_index, positionsExplored;
-        for (i = 0; i < noOfMoves; i++)
-        {
-            printf("parent waiting for a result\n");
-            mailbox_rec(barrier, &move_score, &move_index, &positionsExplored);
-            printf("... parent has received a result: move %d has a score of %d after exploring %d positions\n", move_index, move_score, positionsExplored);
-            *totalExplored += positionsExplored; /* add count to the running total */
-            if (move_score > best)
-            {
-                best = move_score;
-                *move = l[move_index];
-            }
-        }
-    }
-    return best;
-}
-#endif
-
-
-int sequentialSearch (int *totalExplored, int *move,
-		      int best, int *l, int noOfMoves,
-		      BITSET64 c, BITSET64 u, int noPlies, int o, int minscore, int maxscore)
-{
-  int i, try;
-
-  for (i=0; i < noOfMoves; i++)
-    {
-      try = alphaBeta (l[i], c, u, noPlies, o, minscore, maxscore);
-      if (try > best)
-	{
-	  best = try;
-	  *move = l[i];
-	}
-    }
-  *totalExplored = positionsExplored;
-  return best;
-}
-
-
-/*
- *  decideMove - returns the computer choice of move.
- */
-
-static int decideMove (BITSET64 c, BITSET64 u, int o, int n, int *l)
-{
-  time_t start, end;
-  int best, move, try, i;
-  int g = countCounters(u);
-  int totalExplored = 0;  /* use a local copy as this function can be run with the parallel and sequential solution.  */
-
-  if (n == 1) {
-    printf("My move is forced, so I'm not going to delay by considering it..\n");
-    return l[0];
-  }
-
-  noPlies = min(min (noPlies, MAXPOS-g), MAXPLY);
-
-  printf("I'm going to look %d moves ahead...\n", noPlies);
-  if (noPlies + g>=MAXPOS)
-    printf("I should be able to see the end position...\n");
-  positionsExplored = 0;  /* global count reset.  */
-  start = time(NULL);
-  best = MINSCORE-1;  /* ensures that no matter what we will initially set best
-                         to the first move available. */
-#if defined(SEQUENTIAL)
-  best = sequentialSearch (&totalExplored, &move, best, l, n, c, u, noPlies, o, MINSCORE, MAXSCORE);
-#else
-  best = parallelSearch (&totalExplored, &move, best, l, n, c, u, noPlies, o, MINSCORE, MAXSCORE);
-#endif
-  end = time(NULL) ;
-
-#if 0
-  displayBestMoves(noPlies, 1-o);
-#endif
-
-  if (best >= WINSCORE)
-    printf("I think I can force a win\n");
-  if (best <= LOOSESCORE)
-    printf("You should be able to force a win\n");
-
-  if (g+noPlies>=60) {
-    printf("I can see the end of the game and by playing %c%d\n",
-	   (char)(move % MAXX)+'a', move / MAXY+1);
-    printf("will give me a final score of at least %d\n", best);
-  }
-  else
-    printf("I'm playing %c%d which will give me a score of %d\n",
-	   (char)(move % MAXX)+'a', move / MAXY+1, best);
-
-  if (end-start > timePerMove) {
-    printf("I took %d seconds and evaluated %d positions,\nsorry about the wait, I took too long so\nI will reduce my search next go..\n",
-	   (int)(end-start), totalExplored);
-    if (noPlies > 1)
-      noPlies -= 2;
-  }
-  else {
-    printf("time took %d seconds and evaluated %d positions\n",
-	   (int)(end-start), totalExplored);
-    if (end-start < timePerMove / 10)
-      noPlies += 2;
-  }
-
-  return move;
-}
-
-
-/*
- *  computerMove - computer looks ahead and decides best move to play.
- */
-
-static int computerMove (BITSET64 c, BITSET64 u, int o)
-{
-  BITSET64 m = 0;
-  int l[MAXMOVES];
-  int n = findPossible(c, u, o, &m, l);
-  int p;
-
-  displayBoard(c, u, m, FALSE);
-
-  if (countCounters(u) == MAXPOS)
-    return FALSE;
-
-  if (n == 0) {
-    printf("I cannot move...\n");
-    return FALSE;
-  }
-  p = decideMove(c, u, o, n, l);
-  n = makeMove(c, u, p, o, &m, &Colours, &Used);
-  return TRUE;
-}
-
-int main()
-{
-  int s, f;
-
-  if (sizeof(BITSET64) != 8) {
-    printf("BITSET64 must be 64 bits in length\n");
-	exit(1);
-  }
-
-#if !defined(SEQUENTIAL)
-  setupIPC ();
-#endif
-
-  // setupTest();
-  setup();
-
-  f = 0;
-  while (f != 2) {
-# if 1
-    if (humanMove(Colours, Used, 0))
-      f = 0;
-    else
-      f++;
-# else
-    if (computerMove(Colours, Used, 0))
-      f = 0;
-    else
-      f++;
-# endif
-    if (f == 2)
-      break;
-    if (computerMove(Colours, Used, 1))
-      f = 0;
-    else
-      f++;
-  }
-  printf("end of the game and ");
-  s = finalScore(Colours, Used);
-  if (s < 0)
-    printf("you beat me by %d tiles\n", -s);
-  if (s > 0)
-    printf("I won by %d tiles\n", s);
-  if (s == 0)
-    printf("the result is a draw\n");
-  return 0;
-}
+/* Copyright (C) 2007-2021
+ * Free Software Foundation, Inc.
+ *
+ *  Gaius Mulley <gaius@glam.ac.uk> wrote Tiny Othello.
+ */
+
+/*
+This file is part of GNU Tiny Othello
+
+GNU Tiny Othello is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2, or (at your option)
+any later version.
+
+GNU Tiny Othello is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tiny Othello; see the file COPYING.  If not, write to the
+Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+02110-1301, USA.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "board.h"
+#include "ttable.h"
+#include "pattern.h"
+
+#if defined(TRAINER)
+#  include <limits.h>
+#  define engine_c
+#  include "engine.h"
+#endif
+
+#if !defined(SEQUENTIAL)
+#  include <signal.h>
+#  include <pthread.h>
+#  include <sched.h>
+#  include <sys/prctl.h>
+#  include "multiprocessor.h"
+#  include <stddef.h>
+#  include "mailbox.h"
+#endif
+
+#if !defined(TRUE)
+#  define TRUE (1==1)
+#endif
+
+#if !defined(FALSE)
+#  define FALSE (1==0)
+#endif
+
+
+#define IS_OUR_COLOUR(COLOUR,USED,BIT,COL)  \
+                                     (IN((USED),(BIT)) && (IN((COLOUR),(BIT)) == (COL)))
+#define GET_COLOUR(COLOUR,BIT)       (IN((COLOUR),(BIT)))
+#define UN_USED(SET,BIT)             (IN((SET),(BIT)) == 0)
+#define IS_USED(SET,BIT)             (IN((SET),(BIT)) == 1)
+
+#define ASSERT(X)                    do { if (!(X)) { fprintf(stderr, "%s:%d: assert failed\n", __FILE__, __LINE__); exit(1); } } while (0);
+
+#define MAXPLY             14
+#define MAXMOVES           60
+
+#undef USE_CORNER_SCORES
+
+#if defined(USE_CORNER_SCORES)
+#  define CORNERVAL       (64*4)
+#  define PIECEVAL           64
+
+#  define MAXSCORE           (64*64*64)
+#  define MINSCORE          -(64*64*64)
+#else
+#  define CORNERVAL           0
+#  define PIECEVAL            1
+
+#  define MAXSCORE           64
+#  define MINSCORE          -64
+#endif
+
+
+#define WINSCORE       (64*PIECEVAL)
+#define LOOSESCORE    (-64*PIECEVAL)
+
+#define AmountOfTime        1      /* seconds */
+#define CHECKNODES       4096      /* nodes searched between looks at the clock.  */
+#define SPLITDEPTH          4      /* no parallel search closer to the leaves.  */
+#define MAXSPLITPOINTS    256
+#define MAXSEARCHPLY    (2*MAXMOVES)  /* a pass is a ply too.  */
+#define KILLERS             2      /* killer moves remembered at each ply.  */
+#define MAXHISTORY    (1<<19)      /* history scores are halved beyond this.  */
+#define MOBILITYDEPTH       3      /* default depth from which moves are ordered by mobility.  */
+#define MOBILITYVAL        16      /* worth of each opponent move when ordering by mobility.  */
+#define CORNERBONUS        48      /* ordering bonus for taking a corner.  */
+#define PARITYBONUS        16      /* ordering bonus for moving into an odd region.  */
+#define ASPIRATION          2      /* default half width of the root window, in discs.  */
+#define ENDGAMEEMPTIES     18      /* default empty squares from which the end is solved exactly.  */
+#define WLDEMPTIES         20      /* default empty squares from which a win, loss or draw is solved.  */
+#define ENDGAMEPLIES        6      /* plies searched for a move to fall back on should the solver run out of time.  */
+#define FASTESTEMPTIES      5      /* order the endgame fastest first with more empty squares.  */
+#define ENDGAMETABLE        8      /* use the transposition table with at least this many empties.  */
+#define ENDGAMEDEPTH  (MAXPOS+1)   /* depth of solved positions in the transposition table.  */
+#define STABILITYEMPTIES    8      /* bound the endgame by the stable discs with this many empties.  */
+
+/* the search keeps the state of the position at each ply on a stack,
+   deriving each ply incrementally from the one above, see pushMove.  */
+typedef struct plystate_t {
+  board position;         /* seen from the side to move.  */
+  BITSET64 hash;          /* Zobrist hash of the position, see ttable_hash.  */
+  BITSET64 swapped;       /* hash of the position with the sides swapped.  */
+  patterns eval;          /* pattern indices, once the weights are loaded.  */
+} plystate;
+
+#if !defined(TRAINER)
+static BITSET64 Colours;
+static BITSET64 Used;
+static int noPlies = 0;        /* depth of the last completed search.  */
+static int timePerMove = 10;   /* seconds */
+static unsigned int tableSize = TTABLE_DEFAULT_MB;  /* megabytes.  */
+static int aspiration = ASPIRATION*PIECEVAL;  /* half width of the root window, 0 for the full width.  */
+static int endgameEmpties = ENDGAMEEMPTIES;  /* solve exactly with this many empty squares.  */
+static int wldEmpties = WLDEMPTIES;  /* solve for a win, loss or draw with this many.  */
+static char *weights = NULL;   /* file of pattern weights, NULL for the default.  */
+#endif
+static int mobilityDepth = MOBILITYDEPTH;  /* order by mobility with at least this many plies left.  */
+static int stableWeight = 0;   /* weights of the stable discs, frontier discs */
+static int frontierWeight = 0; /* and potential mobility in the evaluation, */
+static int potentialWeight = 0;  /* in 1/PATTERN_SCALE discs, see -F.  */
+#if defined(TRAINER)
+static __thread int history[2][MAXPOS];  /* the trainer's threads each search their own games.  */
+#else
+/* cutoffs by square, for each side relative to the root.  The threads of
+   -T share it, updating it without locks as a lost update does no harm.  */
+static int history[2][MAXPOS];
+#endif
+/* the search state is private to each thread of the threads backend.  */
+static __thread int positionsExplored;  /* no of positions evaluated in the current move.  */
+static __thread long long deadline;     /* microseconds on the monotonic clock.  */
+static __thread int searchAborted;      /* has the current search been abandoned?  */
+static __thread int nodesUntilCheck;
+static __thread int finalDiscs;  /* score the end of the game by its discs rather than as a win or loss.  */
+static __thread int killers[MAXSEARCHPLY][KILLERS];  /* moves which caused a cutoff at each ply.  */
+static __thread struct plystate_t state[MAXSEARCHPLY+1];  /* of the position at each ply, see newState.  */
+#if !defined(SEQUENTIAL)
+static __thread mailbox *inbox;         /* messages from the parent to a worker.  */
+static __thread unsigned int searchEpoch;  /* abort epoch the current search belongs to.  */
+static __thread struct splitpoint_t *currentSplit;  /* innermost split point we search.  */
+#endif
+
+#if 0
+static int bestMove[MAXPLY+1];
+static int bestMoveDepth;
+static int currentMove[MAXPLY+1];
+static int currentDepth;
+#endif
+
+
+/*
+ *  IN - return 1 or 0 depending whether, bit, is in, set.
+ */
+
+static __inline__ int IN (BITSET64 set, int bit)
+{
+  if (sizeof(BITSET64) > sizeof(unsigned int)) {
+    unsigned int *p = (unsigned int *)&set;
+
+    if (bit >= sizeof(unsigned int)*8)
+      /* high unsigned int */
+      return (p[1] >> (bit-(sizeof(unsigned int)*8))) & 1;
+    else
+      /* low */
+      return (p[0] >> bit) & 1;
+  }
+  else
+    return (set >> bit) & 1;
+}
+
+/*
+ *  INCL - set, bit, in, set.
+ */
+
+static __inline__ void INCL (BITSET64 *set, int bit)
+{
+  if (sizeof(BITSET64) > sizeof(unsigned int)) {
+    unsigned int *p = (unsigned int *)set;
+
+    if (bit >= sizeof(unsigned int)*8)
+      /* high unsigned int */
+      p[1] |= 1 << (bit-(sizeof(unsigned int)*8));
+    else
+      /* low */
+      p[0] |= 1 << bit;
+  }
+  else
+    (*set) |= 1 << bit;
+}
+
+/*
+ *  EXCL - unset, bit, in, set.
+ */
+
+static __inline__ void EXCL (BITSET64 *set, int bit)
+{
+  if (sizeof(BITSET64) > sizeof(unsigned int)) {
+    unsigned int *p = (unsigned int *)set;
+
+    if (bit >= sizeof(unsigned int)*8)
+      /* high unsigned int */
+      p[1] &= ~(1 << (bit-(sizeof(unsigned int)*8)));
+    else
+      /* low */
+      p[0] &= ~(1 << bit);
+  }
+  else
+    (*set) &= ~(1 << bit);
+}
+
+/*
+ *  timeNow - returns the monotonic clock in microseconds.
+ */
+
+static long long timeNow (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+#if !defined(SEQUENTIAL)
+/*
+ *  cancelled - returns TRUE if we are a worker and the parent has sent
+ *              us a message.  During a search the only message the
+ *              parent sends is to cancel it.
+ */
+
+static __inline__ int cancelled (void)
+{
+  unsigned int length;
+  int type;
+
+  return inbox != NULL && mailbox_poll(inbox, &type, &length) != NULL;
+}
+
+static int stopRequested (void);
+static void abortSearch (void);
+#endif
+
+/*
+ *  outOfTime - returns TRUE once the search has passed its deadline or
+ *              has been abandoned.  The clock and the abort requests of
+ *              the other searchers are only looked at every CHECKNODES
+ *              calls.
+ */
+
+static __inline__ int outOfTime (void)
+{
+  if (searchAborted)
+    return TRUE;
+  if (--nodesUntilCheck > 0)
+    return FALSE;
+  nodesUntilCheck = CHECKNODES;
+  if (timeNow() >= deadline) {
+    searchAborted = TRUE;
+#if !defined(SEQUENTIAL)
+    abortSearch();  /* stop everyone helping us at once */
+#endif
+  }
+#if !defined(SEQUENTIAL)
+  else if (stopRequested())
+    searchAborted = TRUE;
+#endif
+  return searchAborted;
+}
+
+/*
+ *  makeMove - returns the number of discs turned over should the side
+ *             to move in, b, play on square, p.  The position after the
+ *             move, still seen from the side which moved, is assigned
+ *             to, nb, and p is included in, m, if it is legal.
+ */
+
+static __inline__ int makeMove (board b, int p, BITSET64 *m, board *nb)
+{
+  BITSET64 flips;
+
+  *nb = b;
+  if (UN_USED(b.player | b.opponent, p)) {
+    flips = board_flipMask (b, p);
+    if (flips != 0) {
+      *nb = board_play (b, p, flips);
+      INCL(m, p);
+    }
+    return board_popCount (flips);
+  }
+  return 0;
+}
+
+
+#if !defined(TRAINER)
+static void setup (void)
+{
+  INCL(&Used, 35);
+  INCL(&Colours, 35);
+  INCL(&Used, 36);
+  INCL(&Used, 27);
+  INCL(&Used, 28);
+  INCL(&Colours, 28);
+}
+
+
+static void setupTest (void)
+{
+  int i;
+
+  for (i=49; i<=54; i++) {
+    INCL(&Used, i);
+    if (i % 2 == 0)
+      INCL(&Colours, i);
+  }
+  INCL(&Used, 48);
+  INCL(&Used, 40);
+  INCL(&Used, 57);
+  INCL(&Used, 58);
+  INCL(&Colours, 49);
+  INCL(&Colours, 21);
+
+  for (i=41; i<=46; i++) {
+    INCL(&Used, i);
+    if (i % 2 == 1)
+      INCL(&Colours, i);
+  }
+  for (i=33; i<=38; i++) {
+    INCL(&Used, i);
+    if (i % 2 == 0)
+      INCL(&Colours, i);
+  }
+  for (i=0; i<=55; i++) {
+    INCL(&Used, i);
+    if (i % 2 == 1)
+      INCL(&Colours, i);
+  }
+}
+
+
+static void displayBoard (BITSET64 c, BITSET64 u, BITSET64 h, int hint)
+{
+  int i, j;
+  int pos;
+
+  printf("\n================================\n") ;
+  j=0;
+  for (j=MAXY-1; j>=0; j--) {
+    printf(" %d ", j+1);
+    for (i=0; i<MAXX; i++) {
+      pos = j*MAXY+i;
+      if (IS_USED(u, pos)) {
+	if (IS_OUR_COLOUR(c, u, pos, WHITE))
+	  printf(" W ");
+	else
+	  printf(" B ");
+      }
+      else if (hint && (IN(h, pos)))
+	printf(" @ ");
+      else
+	printf(" . ");
+    }
+    printf("\n");
+  }
+  printf("\n");
+  printf("    a  b  c  d  e  f  g  h\n");
+}
+
+
+static int enterMove (void)
+{
+  char ch;
+  int pos;
+
+  printf("enter your move: ");
+  pos = 0;
+  ch = getchar();
+  if (ch == '?') {
+    ch = getchar();
+    return -1;
+  }
+  do {
+    if ((ch>='a') && (ch<='h')) {
+      pos = pos + (int) (ch - 'a');
+    }
+    ch = getchar();
+    if ((ch>='1') && (ch<='8')) {
+      pos = (pos + ((int) (ch-'1'))*MAXY) % (MAXY*MAXX);
+    }
+    ch = getchar();
+  } while ((pos < 0) && (pos > (MAXX*MAXY-1))) ;
+  printf("entered %d\n", pos);
+  return pos;
+}
+#endif
+
+
+#if 0
+  /*       R   L   U   D  LD RU  LU  RD */
+  makeMove(Colours, Used, 21, 1, NULL, NULL,
+	   23, 16, 61, 5, 3, 39, 56, 7);
+
+  makeMove(Colours, Used, 30, 1, NULL, NULL,
+	   31, 24, 62, 6, 3, 39, 58, 23);
+
+  makeMove(Colours, Used, 43, 1, NULL, NULL,
+	   47, 40, 59, 3, 16, 61, 57, 15);
+
+  makeMove(Colours, Used, 18, 1, NULL, NULL,
+	   23, 16, 58, 2, 0, 63, 32, 4);
+
+  makeMove(Colours, Used, 45, 1, NULL, NULL,
+	   47, 40, 61, 5, 0, 63, 59, 31);
+
+  makeMove(Colours, Used, 50, 1, NULL, NULL,
+	   55, 48, 58, 2, 32, 59, 57, 15);
+
+  makeMove(Colours, Used, 24, 1, NULL, NULL,
+	   31, 24, 56, 0, 24, 60, 24, 3);
+#endif
+
+
+/*
+ *  max - returns the greatest value from, x or y.
+ */
+
+static int max (int x, int y)
+{
+  if (x > y)
+    return x;
+  else
+    return y;
+}
+
+/*
+ *  min - returns the smallest value from, x or y.
+ */
+
+static int min (int x, int y)
+{
+  if (x < y)
+    return x;
+  else
+    return y;
+}
+
+/*
+ *  patternMover - returns the pattern code of the side to move, ply
+ *                 plies below the root.  The root side has the code 1.
+ */
+
+static __inline__ int patternMover (int ply)
+{
+  return 1 + (ply & 1);
+}
+
+/*
+ *  newState - computes from scratch the state of position, b, which
+ *             is, ply, plies below the root.  The plies below are then
+ *             derived from it by pushMove and pushPass.
+ */
+
+static void newState (board b, int ply)
+{
+  plystate *s = &state[ply];
+
+  s->position = b;
+  s->hash = ttable_hash(b);
+  s->swapped = ttable_hash(board_swap(b));
+  if (pattern_loaded())
+    pattern_compute(b, patternMover(ply), &s->eval);
+}
+
+/*
+ *  pushMove - derives the state of ply+1 from that of, ply, as the
+ *             side to move plays on square, p.  Only the square played and
+ *             the discs it turns over are looked at.  A move is undone
+ *             by returning to, ply, whose state is left untouched.
+ */
+
+static __inline__ void pushMove (int ply, int p)
+{
+  plystate *s = &state[ply];
+  plystate *t = &state[ply+1];
+  BITSET64 flips = board_flipMask(s->position, p);
+
+  t->position = board_swap(board_play(s->position, p, flips));
+  t->hash = s->hash;
+  t->swapped = s->swapped;
+  ttable_hashMove(&t->hash, &t->swapped, p, flips);
+  if (pattern_loaded()) {
+    t->eval = s->eval;
+    pattern_play(&t->eval, patternMover(ply), p, flips);
+  }
+}
+
+/*
+ *  pushPass - derives the state of ply+1 from that of, ply, as the
+ *             side to move passes.
+ */
+
+static __inline__ void pushPass (int ply)
+{
+  plystate *s = &state[ply];
+  plystate *t = &state[ply+1];
+
+  t->position = board_swap(s->position);
+  t->hash = s->swapped;
+  t->swapped = s->hash;
+  if (pattern_loaded())
+    t->eval = s->eval;
+}
+
+/*
+ *  evaluateTerms - returns the difference between the sides of position,
+ *                  b, in their stable discs, frontier discs (those next
+ *                  to an empty square) and potential mobility (empty
+ *                  squares next to the other side), weighted as given
+ *                  by -F, in 1/PATTERN_SCALE discs.
+ */
+
+static int evaluateTerms (board b)
+{
+  BITSET64 u = b.player | b.opponent;
+  int score = 0;
+
+  if (stableWeight != 0)
+    score += stableWeight * (board_popCount(board_stable(b.player, u))
+			     - board_popCount(board_stable(b.opponent, u)));
+  if (frontierWeight != 0)
+    score -= frontierWeight * (board_popCount(board_frontier(b.player, u))
+			       - board_popCount(board_frontier(b.opponent, u)));
+  if (potentialWeight != 0)
+    score += potentialWeight * (board_popCount(board_neighbours(b.opponent) & ~u)
+				- board_popCount(board_neighbours(b.player) & ~u));
+  return score;
+}
+
+/*
+ *  evaluate - returns a measure of goodness for the board position,
+ *             ply, plies below the root. A positive value indicates a
+ *             good position for b.player and a negative value means a
+ *             good position for b.opponent.  Once the pattern weights
+ *             are loaded it is scored by its patterns, otherwise by
+ *             its discs, together with any terms weighted by -F.  A
+ *             finished game scores MAXSCORE or MINSCORE, or its final
+ *             disc difference if finalDiscs is set.
+ */
+
+static int evaluate (int ply, int final)
+{
+  board b = state[ply].position;
+  int score, empties;
+
+  positionsExplored++;
+  score = (board_popCount(b.player) - board_popCount(b.opponent)) * PIECEVAL;
+
+  if (final || (b.player | b.opponent) == ALL_SQUARES) {
+    if (finalDiscs) {
+      /* the empty squares go to the winner, as in discDifference */
+      empties = MAXPOS - board_popCount(b.player | b.opponent);
+      if (score > 0)
+	return score + empties * PIECEVAL;
+      if (score < 0)
+	return score - empties * PIECEVAL;
+      return 0;
+    }
+    if (score > 0)
+      return MAXSCORE;
+    if (score < 0)
+      return MINSCORE;
+  }
+
+  if (pattern_loaded() || (stableWeight | frontierWeight | potentialWeight) != 0) {
+    if (pattern_loaded())
+      score = pattern_evaluate(&state[ply].eval, patternMover(ply),
+			       board_popCount(b.player | b.opponent));
+    else
+      score = score / PIECEVAL * PATTERN_SCALE;
+    score += evaluateTerms(b);
+    /* round to the nearest PIECEVAL, short of a proven win or loss */
+    if (score >= 0)
+      score = (score * PIECEVAL + PATTERN_SCALE/2) / PATTERN_SCALE;
+    else
+      score = -((-score * PIECEVAL + PATTERN_SCALE/2) / PATTERN_SCALE);
+    return max(LOOSESCORE+1, min(WINSCORE-1, score));
+  }
+
+#if defined(USE_CORNER_SCORES)
+  score += (board_popCount(b.player & CORNERS)
+	    - board_popCount(b.opponent & CORNERS)) * CORNERVAL;
+#endif
+  return score;
+}
+
+#if !defined(TRAINER)
+/*
+ *  countCounters - returns the number of used positions.
+ */
+
+static int countCounters (BITSET64 u)
+{
+  return board_popCount(u);
+}
+#endif
+
+/*
+ *  findPossible - returns the number of legal moves found.
+ *                 These are also assigned to the bitset, m.
+ */
+
+static int findPossible (board b, BITSET64 *m, int l[])
+{
+  BITSET64 moves = board_legalMoves (b);
+  int n;
+
+  *m |= moves;
+  if (l == NULL)
+    return board_popCount (moves);
+
+  /* lowest square first, the same order as a scan from 0..MAXPOS-1.  */
+  n = 0;
+  while (moves != 0) {
+    l[n] = board_lowestBit (moves);
+    moves &= moves-1;
+    n++;
+  }
+  return n;
+}
+
+/*
+ *  squareValue - the worth of each square in the opening and middle
+ *                game, used to break ties when ordering moves.
+ *                Corners are best, the squares next to them (the C and
+ *                X squares) worst as they offer the corner up.
+ */
+
+static const int squareValue[MAXPOS] = {
+  100, -20,  10,   5,   5,  10, -20, 100,
+  -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+   10,  -2,  -1,  -1,  -1,  -1,  -2,  10,
+    5,  -2,  -1,  -1,  -1,  -1,  -2,   5,
+    5,  -2,  -1,  -1,  -1,  -1,  -2,   5,
+   10,  -2,  -1,  -1,  -1,  -1,  -2,  10,
+  -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+  100, -20,  10,   5,   5,  10, -20, 100
+};
+
+/*
+ *  clearKillers - forget the killer moves of the previous search.
+ */
+
+static void clearKillers (void)
+{
+  memset(killers, -1, sizeof (killers));
+}
+
+/*
+ *  clearOrdering - forget the killer moves and history scores of the
+ *                  previous search.
+ */
+
+static void clearOrdering (void)
+{
+  clearKillers();
+  memset(history, 0, sizeof (history));
+}
+
+/*
+ *  quadrant - returns the quarter of the board containing square, p.
+ */
+
+static __inline__ BITSET64 quadrant (int p)
+{
+  BITSET64 q = 0x000000000F0F0F0FULL;
+
+  if (p % MAXX >= MAXX/2)
+    q <<= MAXX/2;
+  if (p / MAXX >= MAXY/2)
+    q <<= MAXPOS/2;
+  return q;
+}
+
+/*
+ *  fastestFirst - returns the worth of move, p, from position, b, when
+ *                 ordering by mobility.  The fewer moves it leaves the
+ *                 opponent the better, with a bonus for taking a corner
+ *                 and for moving into a quadrant with an odd number of
+ *                 empty squares, so that we should have the last move
+ *                 there.
+ */
+
+static int fastestFirst (board b, int p)
+{
+  BITSET64 empty = ~(b.player | b.opponent);
+  board nb = board_play(b, p, board_flipMask(b, p));
+  int k = (MAXMOVES - board_popCount(board_legalMoves(board_swap(nb)))) * MOBILITYVAL;
+
+  if (CORNERS & (((BITSET64) 1) << p))
+    k += CORNERBONUS;
+  if (board_popCount(empty & quadrant(p)) & 1)
+    k += PARITYBONUS;
+  return k;
+}
+
+/*
+ *  orderMoves - sort the, n, moves in, l, from position, b, at, ply,
+ *               with, depth, plies left to search, so that the most
+ *               promising are searched first.  The move from the
+ *               transposition table, ttMove, comes first, then the
+ *               killer moves of this ply and then the rest.  These are
+ *               ordered by fastestFirst if at least mobilityDepth plies
+ *               remain, as the subtree saved then outweighs the cost,
+ *               otherwise by their history score.  Ties are broken by
+ *               squareValue.
+ */
+
+static void orderMoves (board b, int *l, int n, int ttMove, int ply, int depth)
+{
+  int key[MAXMOVES];
+  int i, j, k, p;
+
+  for (i = 0; i < n; i++) {
+    p = l[i];
+    if (p == ttMove)
+      k = 3 << 28;
+    else if (p == killers[ply][0])
+      k = 2 << 28;
+    else if (p == killers[ply][1])
+      k = 1 << 28;
+    else if (mobilityDepth > 0 && depth >= mobilityDepth)
+      k = (fastestFirst(b, p) << 8) + squareValue[p] + 128;
+    else
+      k = (history[ply & 1][p] << 8) + squareValue[p] + 128;
+    /* insert p, the moves are few so a simple insertion sort will do */
+    for (j = i; j > 0 && key[j-1] < k; j--) {
+      key[j] = key[j-1];
+      l[j] = l[j-1];
+    }
+    key[j] = k;
+    l[j] = p;
+  }
+}
+
+/*
+ *  goodMove - remember that move, p, caused a cutoff at, ply, with,
+ *             depth, plies left to search.
+ */
+
+static void goodMove (int p, int ply, int depth)
+{
+  int *h = history[ply & 1];
+  int i;
+
+  if (killers[ply][0] != p) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = p;
+  }
+  h[p] += depth * depth;
+  if (h[p] > MAXHISTORY)
+    for (i = 0; i < MAXPOS; i++)
+      h[i] /= 2;
+}
+
+#if !defined(TRAINER)
+/*
+ *  doMove - keep requesting user for a legal move.
+ */
+
+static int doMove (BITSET64 c, BITSET64 u, BITSET64 m, int o)
+{
+  int p;
+
+  do {
+    do {
+      if (o == WHITE)
+	printf("white ");
+      else
+	printf("black ");
+      p = enterMove();
+      if (p == -1)
+	displayBoard(c, u, m, TRUE);
+    } while (p == -1);
+    if (! IN(m, p))
+      printf("illegal move\n");
+  } while (! IN(m, p));
+  return p;
+}
+
+/*
+ *  humanMove - asks player to enter a legal move and updates the
+ *              board.
+ */
+
+static int humanMove (BITSET64 c, BITSET64 u, int o)
+{
+  BITSET64 m = 0;
+  board b = board_fromColours(c, u, o);
+  board nb;
+  int l[MAXMOVES];
+  int n = findPossible(b, &m, l);
+  int p;
+
+  displayBoard(c, u, m, FALSE);
+
+  if (countCounters(u) == MAXPOS)
+    return FALSE;
+
+  if (n == 0) {
+    printf("you cannot move...\n");
+    return FALSE;
+  }
+  if (n == 1) {
+    p = l[0];
+    printf("you are forced to play the only move available which is %c%d\n",
+	   ((char)(p % MAXX))+'a', p / MAXY+1);
+  } else
+    p = doMove(c, u, m, o);
+
+  n = makeMove(b, p, &m, &nb);
+  board_toColours(nb, o, &Colours, &Used);
+  return TRUE;
+}
+#endif
+
+static int alphaBeta (int p, int depth, int ply, int alpha, int beta);
+static int scout (int p, int depth, int ply, int alpha, int beta);
+#if !defined(SEQUENTIAL)
+static int splitSearch (board b, int *l, int n, int depth, int ply,
+			int *alpha, int beta, int *bestMove);
+#endif
+
+/*
+ *  fromSolved - converts the entry, e, which the endgame solver scored
+ *               by the final disc difference, to the scores of search,
+ *               where a finished game is simply won or lost.  A bound
+ *               which does not decide the result is dropped, leaving
+ *               only its move.
+ */
+
+static void fromSolved (ttentry *e)
+{
+  switch (e->bound) {
+  case TT_EXACT:
+    e->score = e->score > 0 ? MAXSCORE : e->score < 0 ? MINSCORE : 0;
+    break;
+  case TT_LOWER:
+    if (e->score > 0) {
+      e->bound = TT_EXACT;
+      e->score = MAXSCORE;
+    }
+    else if (e->score < 0)
+      e->bound = TT_NONE;
+    break;
+  case TT_UPPER:
+    if (e->score < 0) {
+      e->bound = TT_EXACT;
+      e->score = MINSCORE;
+    }
+    else if (e->score > 0)
+      e->bound = TT_NONE;
+    break;
+  }
+}
+
+/*
+ *  search - returns the score of the position, b, at, ply, plies,
+ *           including passes, below the root looking, depth, plies
+ *           ahead.  b.player is the side to move and the score, alpha
+ *           and beta are all seen from that side.  passed is TRUE if
+ *           the other side could not move in the previous position.
+ *           This is a principal variation search: only the first move
+ *           is searched with the full window, the others are scouted,
+ *           see scout.
+ */
+
+static int search (int depth, int ply, int alpha, int beta, int passed)
+{
+  board b = state[ply].position;
+  BITSET64 m = 0;
+  BITSET64 hash = state[ply].hash;
+  ttentry e;
+  int l[MAXMOVES];
+  int n, i, try;
+  int oalpha = alpha;
+  int bestMove = TT_NOMOVE;
+
+  if (outOfTime())
+    return 0;
+  if (depth <= 0)
+    return evaluate(ply, FALSE);
+
+  e.move = TT_NOMOVE;
+  if (ttable_probe(hash, &e) && e.depth >= depth) {
+    if (e.depth == ENDGAMEDEPTH && ! finalDiscs)
+      fromSolved(&e);  /* stored by solve */
+    if (e.bound == TT_EXACT)
+      return max(alpha, min(beta, e.score));
+    if (e.bound == TT_LOWER && e.score >= beta)
+      return beta;
+    if (e.bound == TT_UPPER && e.score <= alpha)
+      return alpha;
+  }
+
+  n = findPossible(b, &m, l);
+  if (n == 0) {
+    if (passed)
+      return evaluate(ply, TRUE);
+    /* we forfit a go and the other side plays a move instead */
+    pushPass(ply);
+    return -search(depth, ply+1, -beta, -alpha, TRUE);
+  }
+
+  orderMoves(b, l, n, e.move, ply, depth);
+  for (i=0; i<n; i++) {
+    if (i == 0)
+      try = alphaBeta(l[i], depth, ply, alpha, beta);
+    else
+      try = scout(l[i], depth, ply, alpha, beta);
+    if (searchAborted)
+      return 0;  /* the result is incomplete and must not be remembered */
+    if (try > alpha) {
+      /* found a better move */
+      alpha = try;
+      bestMove = l[i];
+    }
+    if (alpha >= beta) {
+      goodMove(l[i], ply, depth);
+      break;  /* no point searching further as the other side would
+		 choose a different previous move */
+    }
+#if !defined(SEQUENTIAL)
+    /* the eldest brother has been searched, so the younger ones may
+       now be shared with any idle workers */
+    if (i == 0 && depth >= SPLITDEPTH && n > 2
+	&& splitSearch(b, &l[1], n-1, depth, ply, &alpha, beta, &bestMove)) {
+      if (searchAborted)
+	return 0;
+      if (alpha >= beta)
+	goodMove(bestMove, ply, depth);  /* the move which refuted it */
+      break;
+    }
+#endif
+  }
+
+  if (alpha >= beta)
+    ttable_store(hash, depth, TT_LOWER, alpha, bestMove);
+  else if (alpha > oalpha)
+    ttable_store(hash, depth, TT_EXACT, alpha, bestMove);
+  else
+    ttable_store(hash, depth, TT_UPPER, alpha, e.move);
+  return alpha;
+}
+
+/*
+ *  alphaBeta - returns the score estimated should move, p, be chosen.
+ *              The board at, ply, plies below the root is in the state
+ *              _before_ move p is made and is seen from the side
+ *              attempting to play move, p.  The score, alpha and beta
+ *              are all seen from that side and depth includes move, p.
+ */
+
+static int alphaBeta (int p, int depth, int ply, int alpha, int beta)
+{
+  pushMove(ply, p);
+  return -search(depth-1, ply+1, -beta, -alpha, FALSE);
+}
+
+/*
+ *  scout - returns the score of move, p, as alphaBeta, for a move
+ *          expected to be no better than, alpha, the best found so
+ *          far.  A search with a null window is enough to prove it,
+ *          and only should it fail high is the move searched again
+ *          with the full window to find its score.
+ */
+
+static int scout (int p, int depth, int ply, int alpha, int beta)
+{
+  int try;
+
+  pushMove(ply, p);
+  try = -search(depth-1, ply+1, -alpha-1, -alpha, FALSE);
+  if (try > alpha && try < beta && ! searchAborted)
+    try = -search(depth-1, ply+1, -beta, -alpha, FALSE);  /* ply+1 is as we left it */
+  return try;
+}
+
+/*
+ *  The endgame solver searches to the end of the game and scores each
+ *  position by its final disc difference, the empty squares going to
+ *  the winner.  Passes, the transposition table and move ordering are
+ *  handled as in search, but the evaluation and the last four empty
+ *  squares are handled by kernels which only look at those squares.
+ */
+
+/*
+ *  discDifference - returns the final score of position, b, in which
+ *                   neither side can move.
+ */
+
+static __inline__ int discDifference (board b)
+{
+  int d = board_popCount(b.player) - board_popCount(b.opponent);
+  int empties = MAXPOS - board_popCount(b.player | b.opponent);
+
+  positionsExplored++;
+  if (d > 0)
+    return (d + empties) * PIECEVAL;
+  if (d < 0)
+    return (d - empties) * PIECEVAL;
+  return 0;
+}
+
+/*
+ *  lastOne - returns the final score of position, b, whose only empty
+ *            square is, p.  If the side to move cannot play there the
+ *            other side may.
+ */
+
+static __inline__ int lastOne (board b, int p)
+{
+  int d = 2 * board_popCount(b.player) - (MAXPOS-1);
+  BITSET64 flips = board_flipMask(b, p);
+
+  if (flips != 0) {
+    positionsExplored++;
+    return (d + 2 * board_popCount(flips) + 1) * PIECEVAL;
+  }
+  flips = board_flipMask(board_swap(b), p);
+  if (flips != 0) {
+    positionsExplored++;
+    return (d - 2 * board_popCount(flips) - 1) * PIECEVAL;
+  }
+  return discDifference(b);
+}
+
+/*
+ *  lastTwo - returns the final score of position, b, whose empty
+ *            squares are, p and q, within the window alpha..beta.
+ *            passed is TRUE if the other side could not move.
+ */
+
+static int lastTwo (board b, int alpha, int beta, int p, int q, int passed)
+{
+  BITSET64 flips;
+  int best = MINSCORE-1;
+  int try;
+
+  flips = board_flipMask(b, p);
+  if (flips != 0) {
+    best = -lastOne(board_swap(board_play(b, p, flips)), q);
+    if (best >= beta)
+      return best;
+  }
+  flips = board_flipMask(b, q);
+  if (flips != 0) {
+    try = -lastOne(board_swap(board_play(b, q, flips)), p);
+    if (try > best)
+      best = try;
+  }
+  if (best > MINSCORE-1)
+    return best;
+  if (passed)
+    return discDifference(b);
+  return -lastTwo(board_swap(b), -beta, -alpha, p, q, TRUE);
+}
+
+/*
+ *  lastFew - returns the final score of position, b, whose, n, empty
+ *            squares (three or four) are in, sq, within the window
+ *            alpha..beta.  The squares are tried in the order given.
+ */
+
+static int lastFew (board b, int alpha, int beta, int *sq, int n, int passed)
+{
+  BITSET64 flips;
+  board nb;
+  int rest[4];
+  int best = MINSCORE-1;
+  int i, j, k, try;
+
+  for (i = 0; i < n; i++) {
+    flips = board_flipMask(b, sq[i]);
+    if (flips == 0)
+      continue;
+    nb = board_swap(board_play(b, sq[i], flips));
+    for (j = 0, k = 0; j < n; j++)
+      if (j != i)
+	rest[k++] = sq[j];
+    if (n == 3)
+      try = -lastTwo(nb, -beta, -max(alpha, best), rest[0], rest[1], FALSE);
+    else
+      try = -lastFew(nb, -beta, -max(alpha, best), rest, n-1, FALSE);
+    if (try > best) {
+      best = try;
+      if (best >= beta)
+	return best;
+    }
+  }
+  if (best > MINSCORE-1)
+    return best;
+  if (passed)
+    return discDifference(b);
+  return -lastFew(board_swap(b), -beta, -alpha, sq, n, TRUE);
+}
+
+/*
+ *  oddSquares - returns the empty squares of position, b, which lie in
+ *               a quadrant with an odd number of empty squares.  The
+ *               side moving there can expect to have the last move in
+ *               that quadrant.
+ */
+
+static BITSET64 oddSquares (board b)
+{
+  BITSET64 empty = ~(b.player | b.opponent);
+  BITSET64 odd = 0;
+  BITSET64 q;
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    q = quadrant((i & 1) * (MAXX/2) + (i >> 1) * (MAXPOS/2));
+    if (board_popCount(empty & q) & 1)
+      odd |= empty & q;
+  }
+  return odd;
+}
+
+/*
+ *  orderEndgame - sort the, n, moves in, l, from position, b, with the
+ *                 move from the transposition table, ttMove, first.
+ *                 With many empty squares the rest are ordered fastest
+ *                 first, otherwise moves into odd quadrants come first,
+ *                 ties being broken by squareValue.
+ */
+
+static void orderEndgame (board b, int *l, int n, int ttMove, int empties)
+{
+  BITSET64 odd = oddSquares(b);
+  int key[MAXMOVES];
+  int i, j, k, p;
+
+  for (i = 0; i < n; i++) {
+    p = l[i];
+    if (p == ttMove)
+      k = 1 << 28;
+    else if (empties > FASTESTEMPTIES)
+      k = (fastestFirst(b, p) << 8) + squareValue[p] + 128;
+    else
+      k = (((odd >> p) & 1) << 8) + squareValue[p] + 128;
+    for (j = i; j > 0 && key[j-1] < k; j--) {
+      key[j] = key[j-1];
+      l[j] = l[j-1];
+    }
+    key[j] = k;
+    l[j] = p;
+  }
+}
+
+/*
+ *  solve - returns the final score of position, b, within the window
+ *          alpha..beta, seen from the side to move.  It is a principal
+ *          variation search, like search, whose scores are not clamped
+ *          to the window.  passed is TRUE if the other side could not
+ *          move in the previous position.
+ */
+
+static int solve (board b, int alpha, int beta, int passed)
+{
+  BITSET64 empty = ~(b.player | b.opponent);
+  int empties = board_popCount(empty);
+  BITSET64 moves, hash = 0;
+  board nb;
+  ttentry e;
+  int l[MAXMOVES];
+  int sq[4];
+  int n, i, try;
+  int best = MINSCORE-1;
+  int bestMove = TT_NOMOVE;
+  int oalpha = alpha;
+
+  if (empties <= 4) {
+    /* the squares in odd quadrants first, then the rest */
+    BITSET64 odd = oddSquares(b);
+
+    n = 0;
+    for (moves = odd; moves != 0; moves &= moves-1)
+      sq[n++] = board_lowestBit(moves);
+    for (moves = empty & ~odd; moves != 0; moves &= moves-1)
+      sq[n++] = board_lowestBit(moves);
+    switch (empties) {
+    case 0:
+      return discDifference(b);
+    case 1:
+      return lastOne(b, sq[0]);
+    case 2:
+      return lastTwo(b, alpha, beta, sq[0], sq[1], passed);
+    default:
+      return lastFew(b, alpha, beta, sq, n, passed);
+    }
+  }
+
+  if (outOfTime())
+    return 0;
+  if (empties >= STABILITYEMPTIES) {
+    /* the other side keeps its stable discs whatever we play */
+    try = (MAXPOS - 2 * board_popCount(board_stable(b.opponent, ~empty))) * PIECEVAL;
+    if (try <= alpha)
+      return try;
+  }
+  e.move = TT_NOMOVE;
+  if (empties >= ENDGAMETABLE) {
+    hash = ttable_hash(b);
+    if (ttable_probe(hash, &e) && e.depth == ENDGAMEDEPTH) {
+      if (e.bound == TT_EXACT)
+	return e.score;
+      if (e.bound == TT_LOWER && e.score >= beta)
+	return e.score;
+      if (e.bound == TT_UPPER && e.score <= alpha)
+	return e.score;
+    }
+  }
+
+  moves = board_legalMoves(b);
+  if (moves == 0) {
+    if (passed)
+      return discDifference(b);
+    return -solve(board_swap(b), -beta, -alpha, TRUE);
+  }
+  for (n = 0; moves != 0; moves &= moves-1)
+    l[n++] = board_lowestBit(moves);
+  orderEndgame(b, l, n, e.move, empties);
+
+  for (i = 0; i < n; i++) {
+    nb = board_swap(board_play(b, l[i], board_flipMask(b, l[i])));
+    if (i == 0)
+      try = -solve(nb, -beta, -alpha, FALSE);
+    else {
+      try = -solve(nb, -alpha-1, -alpha, FALSE);
+      if (try > alpha && try < beta && ! searchAborted)
+	try = -solve(nb, -beta, -alpha, FALSE);
+    }
+    if (searchAborted)
+      return 0;
+    if (try > best) {
+      best = try;
+      bestMove = l[i];
+      if (best > alpha)
+	alpha = best;
+      if (alpha >= beta)
+	break;
+    }
+  }
+
+  if (empties >= ENDGAMETABLE) {
+    if (best >= beta)
+      ttable_store(hash, ENDGAMEDEPTH, TT_LOWER, best, bestMove);
+    else if (best > oalpha)
+      ttable_store(hash, ENDGAMEDEPTH, TT_EXACT, best, bestMove);
+    else
+      ttable_store(hash, ENDGAMEDEPTH, TT_UPPER, best, e.move);
+  }
+  return best;
+}
+
+/*
+ *  solveRoot - returns the final score of the best of the, n, moves
+ *              in, l, from position, b, within the window alpha..beta
+ *              and assigns it to, move.  If the search is abandoned
+ *              the best move whose search finished is assigned.
+ */
+
+static int solveRoot (int *move, int *l, int n, board b, int alpha, int beta)
+{
+  board nb;
+  int best = MINSCORE-1;
+  int i, try, a;
+
+  orderEndgame(b, l, n, TT_NOMOVE, MAXPOS);
+  *move = l[0];
+  for (i = 0; i < n; i++) {
+    a = max(alpha, best);
+    nb = board_swap(board_play(b, l[i], board_flipMask(b, l[i])));
+    if (i == 0)
+      try = -solve(nb, -beta, -a, FALSE);
+    else {
+      try = -solve(nb, -a-1, -a, FALSE);
+      if (try > a && try < beta && ! searchAborted)
+	try = -solve(nb, -beta, -a, FALSE);
+    }
+    if (searchAborted)
+      break;
+    if (try > best) {
+      best = try;
+      *move = l[i];
+      if (best >= beta)
+	break;
+    }
+  }
+  return best;
+}
+
+#if !defined(TRAINER)
+int sequentialSearch (int *totalExplored, int *move,
+		      int best, int *l, int noOfMoves,
+		      int noPlies, int minscore, int maxscore);
+
+/*
+ *  decideEndgame - returns the computer choice of move from position,
+ *                  b, with, n, moves in, l, when few enough squares
+ *                  remain to solve the rest of the game.  With at most
+ *                  endgameEmpties the final score is found, otherwise
+ *                  only whether the game is won, lost or drawn by
+ *                  searching with a null window around zero.  A short
+ *                  search of ENDGAMEPLIES comes first and its move is
+ *                  played should the solver run out of time without
+ *                  proving a move which does not lose.  The solver
+ *                  runs in the parent alone, the workers stay idle.
+ */
+
+static int decideEndgame (board b, int n, int *l, long long start)
+{
+  int empties = MAXPOS - countCounters(b.player | b.opponent);
+  int exact = empties <= endgameEmpties;
+  int fallback = l[0];
+  int explored = 0;
+  int move, best, depth, iterMove, i;
+
+  for (depth = 1; depth <= min(ENDGAMEPLIES, empties); depth++) {
+    iterMove = l[0];
+    sequentialSearch(&explored, &iterMove, MINSCORE-1, l, n, depth,
+		     MINSCORE, MAXSCORE);
+    if (searchAborted)
+      break;
+    fallback = iterMove;
+    /* search the best move first in the next iteration */
+    for (i=1; i<n; i++)
+      if (l[i] == fallback) {
+	l[i] = l[0];
+	l[0] = fallback;
+	break;
+      }
+  }
+
+  move = fallback;
+  best = MINSCORE-1;
+  if (! searchAborted) {
+    if (exact)
+      best = solveRoot(&move, l, n, b, MINSCORE, MAXSCORE);
+    else
+      best = solveRoot(&move, l, n, b, -1, 1);
+  }
+
+  if (searchAborted) {
+    /* a finished move is only kept if it is proved not to lose */
+    if (best < 0)
+      move = fallback;
+    printf("I ran out of time before solving the end of the game, so I'm playing %c%d\n",
+	   (char)(move % MAXX)+'a', move / MAXY+1);
+  }
+  else if (exact)
+    printf("I have solved the end of the game and by playing %c%d\n"
+	   "will give me a final score of %d\n",
+	   (char)(move % MAXX)+'a', move / MAXY+1, best / PIECEVAL);
+  else
+    printf("I have solved the end of the game and by playing %c%d I %s\n",
+	   (char)(move % MAXX)+'a', move / MAXY+1,
+	   best > 0 ? "will win" : best == 0 ? "can draw" : "expect to lose");
+  printf("time took %.2f seconds and evaluated %d positions\n",
+	 (double)(timeNow()-start) / 1000000.0, positionsExplored);
+  return move;
+}
+
+/*
+ *  finalScore - returns the final score.
+ */
+
+static int finalScore (BITSET64 c, BITSET64 u)
+{
+  return board_popCount(c & u) - board_popCount(u & ~c);
+}
+#endif
+
+#if 0
+/*
+ *  displayBestMoves - dumps the anticipated move sequence
+ */
+
+static void displayBestMoves (int depth, int o)
+{
+  int i;
+
+  printf("I'm anticipating the move sequence:\n");
+  for (i=depth; i>=0; i--) {
+    if (o == WHITE)
+      printf("white ");
+    else
+      printf("black ");
+    o = 1-o;
+    if (bestMove[i] != -1)
+      printf("%c%d\n",
+	     (char)(bestMove[i] % MAXX)+'a', bestMove[i] / MAXY+1);
+  }
+}
+#endif
+
+#if !defined(SEQUENTIAL)
+/*
+ *  A split point holds the younger brothers of a node whose eldest
+ *  brother has been searched.  The owner and any helpers which join
+ *  take moves from it one at a time, each searching with the best
+ *  score found so far, until none remain.
+ */
+
+typedef struct splitpoint_t {
+  volatile int lock;       /* spinlock guarding the fields below.  */
+  volatile int inUse;
+  int closed;              /* no more helpers may join.  */
+  int helpers;             /* number of helpers which have joined.  */
+  int aborted;             /* a searcher abandoned its move unfinished.  */
+  volatile int cutoff;     /* a move failed high, abandon the other moves.  */
+  struct splitpoint_t *parent;  /* split point the owner was searching.  */
+  unsigned int epoch;      /* abort epoch of the owner's search.  */
+  board position;          /* seen from the side to move.  */
+  int moves[MAXMOVES];
+  int noOfMoves;
+  int next;                /* index of the next move to be searched.  */
+  int depth;
+  int ply;                 /* plies below the root of the search.  */
+  int alpha;               /* best score found so far.  */
+  int beta;
+  int bestMove;
+  int explored;            /* positions explored by the helpers.  */
+  long long deadline;
+  sem_t *finished;         /* signalled by each helper as it leaves.  */
+} splitpoint;
+
+/*
+ *  Every searcher, the parent being searcher 0, keeps a deque of the
+ *  split points it owns, outermost first.  The owner pushes and pops
+ *  at the top as its search goes deeper and returns, whereas an idle
+ *  worker steals from the bottom of whichever deque holds the
+ *  shallowest split point with moves left.
+ */
+
+typedef struct searcher_t {
+  volatile int lock;       /* spinlock guarding the deque.  */
+  int noOfSplits;
+  int splits[MAXPOS];      /* indices of our split points, outermost first.  */
+  long long working;       /* microseconds spent on stolen work.  */
+  long long waiting;       /* microseconds spent waiting for our helpers.  */
+} searcher;
+
+typedef struct splitpool_t {
+  volatile int idleWorkers;  /* workers looking for work to steal.  */
+  volatile unsigned int abortEpoch;  /* raised by the parent to abandon a search.  */
+  splitpoint sp[MAXSPLITPOINTS];
+  searcher s[1];             /* the real number of searchers is noWorkers+1.  */
+} splitpool;
+
+/*
+ *  The parent and the workers talk through mailboxes, one for each
+ *  searcher.  Each worker is sent a job in its mailbox at the start of
+ *  every move and a cancellation at the end, and the parent is sent
+ *  the principal variations found by Lazy SMP helpers and a message
+ *  from each worker as it stops.
+ */
+
+#define MSG_STEAL     (MAILBOX_USER+0)  /* steal work from the split points.  */
+#define MSG_LAZY      (MAILBOX_USER+1)  /* search as a Lazy SMP helper, a lazyjob.  */
+#define MSG_CANCEL    (MAILBOX_USER+2)  /* stop the current search.  */
+#define MSG_QUIT      (MAILBOX_USER+3)  /* exit the worker.  */
+#define MSG_PV        (MAILBOX_USER+4)  /* a helper finished an iteration, a pvreport.  */
+#define MSG_STOPPED   (MAILBOX_USER+5)  /* a worker has stopped, the positions it explored.  */
+
+typedef struct lazyjob_t {
+  board position;          /* the root, seen from the side to move.  */
+  int helper;              /* number of the helper, 1..noWorkers.  */
+  int maxDepth;
+  long long deadline;
+  unsigned int epoch;
+} lazyjob;
+
+typedef struct pvreport_t {
+  int depth;               /* plies searched.  */
+  int score;
+  int length;              /* number of moves in the variation.  */
+  int moves[MAXPOS];       /* only length moves are sent.  */
+} pvreport;
+
+#define PVREPORT_SIZE(N)   (offsetof (pvreport, moves) + (N) * sizeof (int))
+
+static splitpool *pool;
+static mailbox **mailboxes;     /* the parent's is 0, then each worker's.  */
+static int workersRunning;      /* workers which have not yet stopped.  */
+static int noWorkers;
+static int useThreads = FALSE;  /* threads rather than processes?  */
+static int lazySMP = FALSE;     /* Lazy SMP rather than young brothers wait?  */
+static int hugePages = FALSE;   /* back the shared memory with huge pages?  */
+static int interleave = FALSE;  /* spread the shared memory over the NUMA nodes?  */
+static char *affinity = NULL;   /* policy pinning the searchers to processors.  */
+static int processors = 0;      /* processors to use, 0 to find out.  */
+static pid_t *workers;
+static pthread_t *threads;
+static __thread int searcherId;  /* our deque in pool->s, the parent is 0.  */
+
+
+static __inline__ void spinLock (volatile int *lock)
+{
+  while (__sync_lock_test_and_set(lock, 1))
+    while (*lock)
+      ;
+}
+
+static __inline__ void spinUnlock (volatile int *lock)
+{
+  __sync_lock_release(lock);
+}
+
+/*
+ *  stopRequested - returns TRUE if the search we are part of should be
+ *                  abandoned.  Either the parent has raised the abort
+ *                  epoch, a move at one of the split points we are
+ *                  searching below has failed high, or we are a worker
+ *                  whose search has been cancelled.
+ */
+
+static int stopRequested (void)
+{
+  splitpoint *sp;
+
+  if (pool->abortEpoch != searchEpoch)
+    return TRUE;
+  for (sp = currentSplit; sp != NULL; sp = sp->parent)
+    if (sp->cutoff)
+      return TRUE;
+  return cancelled();
+}
+
+/*
+ *  abortSearch - the parent asks every searcher helping it to abandon
+ *                the current search.
+ */
+
+static void abortSearch (void)
+{
+  if (searcherId == 0)
+    __sync_fetch_and_add(&pool->abortEpoch, 1);
+}
+
+/*
+ *  searchSplit - search the moves of split point, sp, one at a time
+ *                until none remain.  Should a move fail high, the
+ *                searchers still busy with the other moves abandon them.
+ */
+
+static void searchSplit (splitpoint *sp)
+{
+  splitpoint *outer = currentSplit;
+  int i, alpha, beta, try;
+
+  currentSplit = sp;
+  newState(sp->position, sp->ply);  /* a helper arrives with none */
+  for (;;) {
+    spinLock(&sp->lock);
+    i = sp->next;
+    if (i < sp->noOfMoves)
+      sp->next++;
+    alpha = sp->alpha;
+    beta = sp->beta;
+    spinUnlock(&sp->lock);
+    if (i >= sp->noOfMoves)
+      break;
+
+    try = scout(sp->moves[i], sp->depth, sp->ply, alpha, beta);
+
+    spinLock(&sp->lock);
+    if (searchAborted) {
+      if (! sp->cutoff)
+	sp->aborted = TRUE;
+      sp->next = sp->noOfMoves;
+    }
+    else if (try > sp->alpha) {
+      sp->alpha = try;
+      sp->bestMove = sp->moves[i];
+      if (sp->alpha >= sp->beta) {
+	sp->next = sp->noOfMoves;  /* cutoff, hand out no more moves */
+	sp->cutoff = TRUE;
+      }
+    }
+    spinUnlock(&sp->lock);
+    if (searchAborted)
+      break;
+  }
+  currentSplit = outer;
+
+  /* if only the moves of sp were abandoned, the search above carries on */
+  if (searchAborted && sp->cutoff && timeNow() < deadline && ! stopRequested())
+    searchAborted = FALSE;
+}
+
+/*
+ *  splitSearch - search the, n, moves in, l, from position, b, with
+ *                the help of any idle workers.  alpha and bestMove are
+ *                updated should a better move be found, so after a
+ *                cutoff bestMove is the move which refuted the position.
+ *                It returns FALSE, having searched nothing, if no worker
+ *                is idle.
+ */
+
+static int splitSearch (board b, int *l, int n, int depth, int ply,
+			int *alpha, int beta, int *bestMove)
+{
+  searcher *s = &pool->s[searcherId];
+  splitpoint *sp = NULL;
+  long long waitStart;
+  int i, helpers;
+
+  if (lazySMP || pool->idleWorkers <= 0 || s->noOfSplits == MAXPOS)
+    return FALSE;
+  for (i = 0; i < MAXSPLITPOINTS; i++)
+    if (__sync_bool_compare_and_swap(&pool->sp[i].inUse, FALSE, TRUE)) {
+      sp = &pool->sp[i];
+      break;
+    }
+  if (sp == NULL)
+    return FALSE;
+
+  spinLock(&sp->lock);
+  sp->closed = FALSE;
+  sp->helpers = 0;
+  sp->aborted = FALSE;
+  sp->cutoff = FALSE;
+  sp->parent = currentSplit;
+  sp->epoch = searchEpoch;
+  sp->position = b;
+  for (i = 0; i < n; i++)
+    sp->moves[i] = l[i];
+  sp->noOfMoves = n;
+  sp->next = 0;
+  sp->depth = depth;
+  sp->ply = ply;
+  sp->alpha = *alpha;
+  sp->beta = beta;
+  sp->bestMove = TT_NOMOVE;
+  sp->explored = 0;
+  sp->deadline = deadline;
+  spinUnlock(&sp->lock);
+
+  /* offer the moves to the idle workers */
+  spinLock(&s->lock);
+  s->splits[s->noOfSplits++] = sp - pool->sp;
+  spinUnlock(&s->lock);
+
+  searchSplit(sp);
+
+  spinLock(&s->lock);
+  s->noOfSplits--;
+  spinUnlock(&s->lock);
+  spinLock(&sp->lock);
+  sp->closed = TRUE;
+  helpers = sp->helpers;
+  spinUnlock(&sp->lock);
+  if (helpers > 0) {
+    waitStart = timeNow();
+    for (i = 0; i < helpers; i++)
+      multiprocessor_wait(sp->finished);
+    s->waiting += timeNow() - waitStart;
+  }
+
+  /* a move is only counted once it has been searched to the end, so
+     the best move is kept even if the others were abandoned */
+  positionsExplored += sp->explored;
+  if (sp->bestMove != TT_NOMOVE) {
+    *alpha = sp->alpha;
+    *bestMove = sp->bestMove;
+  }
+  if (sp->aborted)
+    searchAborted = TRUE;
+  __sync_synchronize();
+  sp->inUse = FALSE;
+  return TRUE;
+}
+
+/*
+ *  findWork - returns the shallowest split point of another searcher
+ *             which still has moves to search, having joined it as a
+ *             helper.  NULL is returned if there is no such split point.
+ */
+
+static splitpoint *findWork (void)
+{
+  splitpoint *best = NULL;
+  splitpoint *sp;
+  int i, k, joined;
+
+  for (i = 0; i <= noWorkers; i++) {
+    searcher *s = &pool->s[i];
+
+    if (i == searcherId || s->noOfSplits == 0)
+      continue;
+    spinLock(&s->lock);
+    for (k = 0; k < s->noOfSplits; k++) {
+      sp = &pool->sp[s->splits[k]];
+      if (! sp->closed && sp->next < sp->noOfMoves) {
+	if (best == NULL || sp->depth > best->depth)
+	  best = sp;
+	break;  /* the rest of this deque is deeper */
+      }
+    }
+    spinUnlock(&s->lock);
+  }
+  if (best == NULL)
+    return NULL;
+
+  spinLock(&best->lock);
+  joined = best->inUse && ! best->closed && best->next < best->noOfMoves;
+  if (joined)
+    best->helpers++;
+  spinUnlock(&best->lock);
+  if (joined)
+    return best;
+  return NULL;  /* the owner finished it before we arrived */
+}
+
+/*
+ *  helpSplit - help the owner of split point, sp, search its moves.
+ *              We must already have joined sp.
+ */
+
+static void helpSplit (splitpoint *sp)
+{
+  long long start = timeNow();
+
+  positionsExplored = 0;
+  deadline = sp->deadline;
+  searchAborted = FALSE;
+  nodesUntilCheck = CHECKNODES;
+  searchEpoch = sp->epoch;
+  searchSplit(sp);
+  __sync_fetch_and_add(&sp->explored, positionsExplored);
+  pool->s[searcherId].working += timeNow() - start;
+  multiprocessor_signal(sp->finished);
+}
+
+/*
+ *  stopped - tell the parent we have stopped searching and the
+ *            number of positions, explored, we looked at.  The cancel
+ *            request which stopped us is removed from our inbox first.
+ */
+
+static void stopped (int explored)
+{
+  unsigned int length;
+  int type;
+  int *msg;
+
+  mailbox_receive(inbox, &type, &length);
+  mailbox_release(inbox);
+  msg = (int *) mailbox_reserve(mailboxes[0], MSG_STOPPED, sizeof (int));
+  *msg = explored;
+  mailbox_commit(mailboxes[0], msg);
+}
+
+/*
+ *  stealWork - help at the shallowest split point of the other
+ *              searchers, one after another, until the parent cancels
+ *              the search.
+ */
+
+static void stealWork (void)
+{
+  splitpoint *sp;
+
+  if (useThreads)
+    clearKillers();  /* the parent has cleared the history we share */
+  else
+    clearOrdering();
+  __sync_fetch_and_add(&pool->idleWorkers, 1);
+  while (! cancelled()) {
+    sp = findWork();
+    if (sp == NULL)
+      sched_yield();
+    else {
+      __sync_fetch_and_sub(&pool->idleWorkers, 1);
+      helpSplit(sp);
+      __sync_fetch_and_add(&pool->idleWorkers, 1);
+    }
+  }
+  __sync_fetch_and_sub(&pool->idleWorkers, 1);
+  stopped(0);  /* helpers add their positions to the split points */
+}
+
+
+/*
+ *  reportPV - send the parent the principal variation, starting with
+ *             move, p, from position, b, found by a search of, depth,
+ *             plies which scored, score.  The rest of the variation is
+ *             read back from the transposition table.
+ */
+
+static void reportPV (board b, int p, int depth, int score)
+{
+  pvreport *r;
+  BITSET64 m = 0;
+  board nb;
+  ttentry e;
+  int moves[MAXPOS];
+  int n = 0;
+
+  while (n < depth && makeMove(b, p, &m, &nb) > 0) {
+    moves[n++] = p;
+    b = board_swap(nb);
+    if (! ttable_probe(ttable_hash(b), &e) || e.move == TT_NOMOVE)
+      break;
+    p = e.move;
+  }
+
+  r = (pvreport *) mailbox_reserve(mailboxes[0], MSG_PV, PVREPORT_SIZE(n));
+  r->depth = depth;
+  r->score = score;
+  r->length = n;
+  memcpy(r->moves, moves, n * sizeof (int));
+  mailbox_commit(mailboxes[0], r);
+}
+
+
+/*
+ *  lazySearch - a Lazy SMP helper.  Search the root position given
+ *               in, j, by iterative deepening until the parent cancels
+ *               the search or the deadline passes.  The principal
+ *               variation of each completed iteration is reported to
+ *               the parent, otherwise the helper is only useful for
+ *               the entries it leaves in the shared transposition
+ *               table.  Helpers are kept apart by starting odd
+ *               numbered helpers one ply deeper and by rotating the
+ *               order of the root moves.
+ */
+
+static void lazySearch (lazyjob *j)
+{
+  board b = j->position;
+  BITSET64 m = 0;
+  int l[MAXMOVES];
+  int n = findPossible(b, &m, l);
+  int depth, i, alpha, try, move;
+
+  positionsExplored = 0;
+  deadline = j->deadline;
+  searchAborted = FALSE;
+  nodesUntilCheck = CHECKNODES;
+  searchEpoch = j->epoch;
+  if (useThreads)
+    clearKillers();  /* the parent has cleared the history we share */
+  else
+    clearOrdering();
+  newState(b, 0);
+
+  for (depth = 1 + j->helper % 2; depth <= j->maxDepth; depth++) {
+    alpha = MINSCORE-1;
+    move = l[0];
+    for (i = 0; i < n; i++) {
+      if (i == 0)
+	try = alphaBeta(l[(i + j->helper) % n], depth, 0, alpha, MAXSCORE);
+      else
+	try = scout(l[(i + j->helper) % n], depth, 0, alpha, MAXSCORE);
+      if (searchAborted)
+	break;
+      if (try > alpha) {
+	alpha = try;
+	move = l[(i + j->helper) % n];
+      }
+    }
+    if (searchAborted)
+      break;
+    reportPV(b, move, depth, alpha);
+  }
+  stopped(positionsExplored);
+}
+
+
+/*
+ *  startWorkers - set every worker to help the parent search position,
+ *                 b, until stopWorkers is called.  The workers either
+ *                 steal work from the split points or run as Lazy SMP
+ *                 helpers.
+ */
+
+static void startWorkers (board b, int maxDepth)
+{
+  lazyjob *j;
+  int i;
+
+  for (i = 0; i <= noWorkers; i++) {
+    pool->s[i].working = 0;
+    pool->s[i].waiting = 0;
+  }
+  for (i = 1; i <= noWorkers; i++)
+    if (lazySMP) {
+      j = (lazyjob *) mailbox_reserve(mailboxes[i], MSG_LAZY, sizeof (lazyjob));
+      j->position = b;
+      j->helper = i;
+      j->maxDepth = maxDepth;
+      j->deadline = deadline;
+      j->epoch = searchEpoch;
+      mailbox_commit(mailboxes[i], j);
+    }
+    else
+      mailbox_commit(mailboxes[i], mailbox_reserve(mailboxes[i], MSG_STEAL, 0));
+  workersRunning = noWorkers;
+}
+
+
+/*
+ *  readReports - read the messages the workers have sent the parent.
+ *                The deepest principal variation is kept in, deepest,
+ *                and the positions explored by workers which have
+ *                stopped are added to, totalExplored.  If, wait, is
+ *                TRUE it waits for every worker to stop.
+ */
+
+static void readReports (int wait, int *totalExplored, pvreport *deepest)
+{
+  pvreport *r;
+  unsigned int length;
+  int type;
+
+  for (;;) {
+    if (wait && workersRunning > 0)
+      r = (pvreport *) mailbox_receive(mailboxes[0], &type, &length);
+    else {
+      r = (pvreport *) mailbox_poll(mailboxes[0], &type, &length);
+      if (r == NULL)
+	return;
+    }
+    if (type == MSG_PV && r->depth > deepest->depth)
+      memcpy(deepest, r, length);
+    else if (type == MSG_STOPPED) {
+      *totalExplored += *(int *) r;
+      workersRunning--;
+    }
+    mailbox_release(mailboxes[0]);
+  }
+}
+
+
+/*
+ *  stopWorkers - cancel the search of every worker and wait for them
+ *                to stop, see readReports.
+ */
+
+static void stopWorkers (int *totalExplored, pvreport *deepest)
+{
+  int i;
+
+  for (i = 1; i <= noWorkers; i++)
+    mailbox_commit(mailboxes[i], mailbox_reserve(mailboxes[i], MSG_CANCEL, 0));
+  readReports(TRUE, totalExplored, deepest);
+}
+
+
+/*
+ *  reportLoad - display the fraction of, elapsed, microseconds each
+ *               searcher spent searching rather than waiting.
+ */
+
+static void reportLoad (long long elapsed)
+{
+  int i;
+
+  if (lazySMP || noWorkers == 0 || elapsed <= 0)
+    return;
+  printf("I was busy for %d%% of the time and my workers for",
+	 (int) ((elapsed - pool->s[0].waiting) * 100 / elapsed));
+  for (i = 1; i <= noWorkers; i++)
+    printf(" %d%%",
+	   (int) ((pool->s[i].working - pool->s[i].waiting) * 100 / elapsed));
+  printf("\n");
+}
+
+
+/*
+ *  serveJobs - runs in each worker of the pool.  It waits in its inbox
+ *              for a search to help with, either by stealing work or
+ *              as a Lazy SMP helper, until it is asked to quit.
+ */
+
+static void serveJobs (void)
+{
+  lazyjob j;
+  unsigned int length;
+  int type;
+  void *msg;
+
+  inbox = mailboxes[searcherId];
+  for (;;) {
+    msg = mailbox_receive(inbox, &type, &length);
+    if (type == MSG_LAZY)
+      j = *(lazyjob *) msg;
+    mailbox_release(inbox);
+    if (type == MSG_QUIT)
+      return;
+    if (type == MSG_STEAL)
+      stealWork();
+    else if (type == MSG_LAZY)
+      lazySearch(&j);
+  }
+}
+
+
+/*
+ *  workerThread - the body of a worker in the threads backend.
+ */
+
+static void *workerThread (void *arg)
+{
+  searcherId = (int) (long) arg;
+  multiprocessor_pin(searcherId);
+  serveJobs();
+  return NULL;
+}
+
+
+/*
+ *  setupIPC - create the split points, mailboxes and the pool of
+ *             workers.  The workers are processes unless useThreads
+ *             is set.  The transposition table must already exist so
+ *             the workers share it.
+ */
+
+void setupIPC (void)
+{
+  int i;
+
+  /* we search alongside the workers, so leave a processor for us */
+  noWorkers = multiprocessor_maxProcessors () - 1;
+
+  pool = (splitpool *) multiprocessor_initSharedMemory
+    (sizeof (splitpool) + noWorkers * sizeof (searcher), MAXSPLITPOINTS);
+  for (i = 0; i < MAXSPLITPOINTS; i++)
+    pool->sp[i].finished = multiprocessor_initSem (0);
+
+  /* our inbox holds a principal variation from each helper for many
+     iterations, the workers' only hold a job and its cancellation */
+  mailboxes = (mailbox **) malloc ((noWorkers+1) * sizeof (mailbox *));
+  mailboxes[0] = mailbox_initSize (64 * 1024);
+  for (i = 1; i <= noWorkers; i++)
+    mailboxes[i] = mailbox_initSize (256);
+
+  if (useThreads) {
+    threads = (pthread_t *) malloc (noWorkers * sizeof (pthread_t));
+    for (i = 0; i < noWorkers; i++)
+      if (pthread_create(&threads[i], NULL, workerThread, (void *) (long) (i+1)) != 0) {
+	printf("unable to create the worker threads\n");
+	exit(1);
+      }
+  }
+  else {
+    workers = (pid_t *) malloc (noWorkers * sizeof (pid_t));
+    fflush(stdout);  /* otherwise the workers would print our buffered output again */
+    for (i = 0; i < noWorkers; i++) {
+      workers[i] = fork();
+      if (workers[i] == 0) {
+	prctl(PR_SET_PDEATHSIG, SIGTERM);  /* do not outlive the parent */
+	searcherId = i+1;
+	multiprocessor_pin(searcherId);
+	serveJobs();
+	_exit(0);
+      }
+      if (workers[i] < 0) {
+	printf("unable to create the worker processes\n");
+	exit(1);
+      }
+    }
+  }
+  multiprocessor_pin(0);
+  multiprocessor_reportProcessors();
+  printf("searching with %d worker %s using %s\n", noWorkers,
+	 useThreads ? "threads" : "processes",
+	 lazySMP ? "Lazy SMP" : "young brothers wait");
+  if (affinity != NULL) {
+    printf("searchers pinned %s to processors", affinity);
+    for (i = 0; i <= noWorkers; i++)
+      printf(" %d", multiprocessor_processorFor(i));
+    printf("\n");
+  }
+}
+
+
+/*
+ *  finishIPC - ask every worker to quit and wait for them to exit.
+ *              Then the semaphores and shared memory, including the
+ *              transposition table, are released.
+ */
+
+void finishIPC (void)
+{
+  int i;
+
+  for (i = 1; i <= noWorkers; i++)
+    mailbox_commit(mailboxes[i], mailbox_reserve(mailboxes[i], MSG_QUIT, 0));
+  if (useThreads) {
+    for (i = 0; i < noWorkers; i++)
+      pthread_join(threads[i], NULL);
+    free(threads);
+  }
+  else {
+    for (i = 0; i < noWorkers; i++)
+      waitpid(workers[i], NULL, 0);
+    free(workers);
+  }
+  free(mailboxes);
+  _M2_multiprocessor_finish ();
+}
+
+
+/*
+ *  parallelSearch - search the, noOfMoves, root moves in, l, using
+ *                   young brothers wait.  The first (principal) move
+ *                   is searched on its own to establish a bound, the
+ *                   other moves are then placed in a split point from
+ *                   which the workers steal them.  Idle workers also
+ *                   steal from split points deeper in the tree, the
+ *                   shallowest first.  The root is the position at ply
+ *                   0 of the search state.
+ */
+int parallelSearch (int *totalExplored, int *move,
+		    int best, int *l, int noOfMoves,
+		    int noPlies, int minscore, int maxscore)
+{
+  int before = positionsExplored;
+  int i, try;
+
+  try = alphaBeta(l[0], noPlies, 0, minscore, maxscore);
+  if (! searchAborted) {
+    if (try > best) {
+      best = try;
+      *move = l[0];
+    }
+    if (noOfMoves > 1 && best < maxscore
+	&& ! splitSearch(state[0].position, &l[1], noOfMoves-1, noPlies, 0,
+			 &best, maxscore, move))
+      /* no worker is free, so search the rest of the moves ourself */
+      for (i = 1; i < noOfMoves && best < maxscore && ! searchAborted; i++) {
+	try = scout(l[i], noPlies, 0, best, maxscore);
+	if (try > best && ! searchAborted) {
+	  best = try;
+	  *move = l[i];
+	}
+      }
+  }
+  *totalExplored += positionsExplored - before;
+  return best;
+}
+#endif
+
+
+int sequentialSearch (int *totalExplored, int *move,
+		      int best, int *l, int noOfMoves,
+		      int noPlies, int minscore, int maxscore)
+{
+  int i, try;
+  int before = positionsExplored;
+
+  for (i=0; i < noOfMoves; i++)
+    {
+      if (i == 0)
+	try = alphaBeta (l[i], noPlies, 0, max (best, minscore), maxscore);
+      else
+	try = scout (l[i], noPlies, 0, max (best, minscore), maxscore);
+      if (searchAborted)
+	break;
+      if (try > best)
+	{
+	  best = try;
+	  *move = l[i];
+	}
+      if (best >= maxscore)
+	break;  /* nothing can be better */
+    }
+  *totalExplored += positionsExplored - before;
+  return best;
+}
+
+
+#if !defined(TRAINER)
+/*
+ *  aspirate - returns the score of the best of the, n, root moves in,
+ *             l, searching, depth, plies ahead, and assigns it to,
+ *             move.  The search is given a window of
+ *             aspiration either side of, guess, the score of the
+ *             search two plies shallower (the score swings between odd
+ *             and even depths as the side with the last move gains).
+ *             Should the score fall outside the window it is searched
+ *             again with that side opened up.
+ */
+
+static int aspirate (int *totalExplored, int *move, int *l, int n,
+		     int depth, int guess)
+{
+  int lo = MINSCORE;
+  int hi = MAXSCORE;
+  int try;
+
+  if (aspiration > 0 && depth > 2) {
+    lo = max(guess - aspiration, MINSCORE);
+    hi = min(guess + aspiration, MAXSCORE);
+  }
+  for (;;) {
+    *move = l[0];
+    try = MINSCORE-1;  /* ensures that no matter what we will initially set
+			  try to the first move available. */
+#if defined(SEQUENTIAL)
+    try = sequentialSearch (totalExplored, move, try, l, n, depth, lo, hi);
+#else
+    if (lazySMP)
+      /* the helpers only share our transposition table */
+      try = sequentialSearch (totalExplored, move, try, l, n, depth, lo, hi);
+    else
+      try = parallelSearch (totalExplored, move, try, l, n, depth, lo, hi);
+#endif
+    if (searchAborted)
+      return try;
+    if (try <= lo && lo > MINSCORE)
+      lo = MINSCORE;  /* failed low */
+    else if (try >= hi && hi < MAXSCORE)
+      hi = MAXSCORE;  /* failed high */
+    else
+      return try;
+  }
+}
+
+
+/*
+ *  decideMove - returns the computer choice of move.  The search is
+ *               repeated one ply deeper each time until timePerMove
+ *               has been used, and the move from the deepest completed
+ *               search is played.
+ */
+
+static int decideMove (board b, int n, int *l)
+{
+  long long start, end;
+  int best, move, try, i, depth;
+  int guess[2];           /* score of the last odd and even depth searches.  */
+  int g = countCounters(b.player | b.opponent);
+  int totalExplored = 0;  /* use a local copy as this function can be run with the parallel and sequential solution.  */
+#if !defined(SEQUENTIAL)
+  pvreport deepest;       /* deepest principal variation of the Lazy SMP helpers.  */
+#endif
+
+  if (n == 1) {
+    printf("My move is forced, so I'm not going to delay by considering it..\n");
+    return l[0];
+  }
+
+  positionsExplored = 0;  /* global count reset.  */
+  ttable_newSearch();
+  start = timeNow();
+  deadline = start + timePerMove * 1000000LL;
+  searchAborted = FALSE;
+  nodesUntilCheck = CHECKNODES;
+  noPlies = 0;
+  guess[0] = guess[1] = 0;
+  clearOrdering();
+  newState(b, 0);
+  orderMoves(b, l, n, TT_NOMOVE, 0, 0);
+  move = l[0];
+  best = MINSCORE-1;
+#if !defined(SEQUENTIAL)
+  searchEpoch = pool->abortEpoch;
+  currentSplit = NULL;
+#endif
+  if (MAXPOS-g <= max(endgameEmpties, wldEmpties))
+    return decideEndgame(b, n, l, start);
+#if !defined(SEQUENTIAL)
+  deepest.depth = 0;
+  startWorkers(b, MAXPOS-g);
+#endif
+
+  for (depth = 1; depth <= MAXPOS-g; depth++) {
+    int iterMove = l[0];
+
+    try = aspirate (&totalExplored, &iterMove, l, n, depth, guess[depth & 1]);
+    if (searchAborted) {
+      /* the previous best move is searched first, so if it was finished
+	 any move which beat it in the abandoned iteration is better */
+      if (try > MINSCORE-1 && iterMove != move) {
+	best = try;
+	move = iterMove;
+      }
+      break;
+    }
+    best = try;
+    move = iterMove;
+    noPlies = depth;
+    guess[depth & 1] = best;
+
+    /* search the best move first in the next iteration */
+    for (i=1; i<n; i++)
+      if (l[i] == move) {
+	l[i] = l[0];
+	l[0] = move;
+	break;
+      }
+#if !defined(SEQUENTIAL)
+    readReports(FALSE, &totalExplored, &deepest);  /* keep our inbox from filling up */
+#endif
+
+    if (best >= WINSCORE) {
+      /* a forced win has been found, so looking deeper is pointless */
+#if !defined(SEQUENTIAL)
+      abortSearch();
+#endif
+      break;
+    }
+
+    /* the next iteration is unlikely to finish in the remaining time */
+    if ((timeNow() - start) * 2 > deadline - start)
+      break;
+  }
+#if !defined(SEQUENTIAL)
+  stopWorkers(&totalExplored, &deepest);
+  if (deepest.depth > noPlies) {
+    /* a helper completed a deeper search than ours */
+    printf("a helper looked %d moves ahead and expects", deepest.depth);
+    for (i=0; i<deepest.length; i++)
+      printf(" %c%d", (char)(deepest.moves[i] % MAXX)+'a', deepest.moves[i] / MAXY+1);
+    printf("\n");
+    noPlies = deepest.depth;
+    best = deepest.score;
+    move = deepest.moves[0];
+  }
+#endif
+  end = timeNow();
+
+#if 0
+  displayBestMoves(noPlies, 1-o);
+#endif
+
+  if (noPlies == 0) {
+    printf("I ran out of time before finishing a search, so I'm playing %c%d\n",
+	   (char)(move % MAXX)+'a', move / MAXY+1);
+    return move;
+  }
+
+  printf("I looked %d moves ahead...\n", noPlies);
+  if (best >= WINSCORE)
+    printf("I think I can force a win\n");
+  if (best <= LOOSESCORE)
+    printf("You should be able to force a win\n");
+
+  if (g+noPlies>=MAXPOS) {
+    printf("I can see the end of the game and by playing %c%d\n",
+	   (char)(move % MAXX)+'a', move / MAXY+1);
+    printf("will give me a final score of at least %d\n", best);
+  }
+  else
+    printf("I'm playing %c%d which will give me a score of %d\n",
+	   (char)(move % MAXX)+'a', move / MAXY+1, best);
+
+  printf("time took %.2f seconds and evaluated %d positions\n",
+	 (double)(end-start) / 1000000.0, totalExplored);
+#if !defined(SEQUENTIAL)
+  reportLoad(end-start);
+#endif
+
+  return move;
+}
+
+
+/*
+ *  computerMove - computer looks ahead and decides best move to play.
+ */
+
+static int computerMove (BITSET64 c, BITSET64 u, int o)
+{
+  BITSET64 m = 0;
+  board b = board_fromColours(c, u, o);
+  board nb;
+  int l[MAXMOVES];
+  int n = findPossible(b, &m, l);
+  int p;
+
+  displayBoard(c, u, m, FALSE);
+
+  if (countCounters(u) == MAXPOS)
+    return FALSE;
+
+  if (n == 0) {
+    printf("I cannot move...\n");
+    return FALSE;
+  }
+  p = decideMove(b, n, l);
+  n = makeMove(b, p, &m, &nb);
+  board_toColours(nb, o, &Colours, &Used);
+  return TRUE;
+}
+#endif
+
+#if defined(TRAINER)
+/*
+ *  newEngineSearch - prepares the search state of this thread to
+ *                    search position, b, without a time limit.
+ */
+
+static void newEngineSearch (board b)
+{
+  deadline = LLONG_MAX;
+  searchAborted = FALSE;
+  nodesUntilCheck = CHECKNODES;
+  finalDiscs = TRUE;  /* labels must be in discs, even for a won game */
+  clearOrdering();
+  newState(b, 0);
+}
+
+/*
+ *  engine_search - returns the score of position, b, searched, depth,
+ *                  plies ahead and assigns the best move to, move.
+ *                  The shallower searches leading up to it order the
+ *                  root moves, best first.
+ */
+
+int engine_search (board b, int depth, int *move)
+{
+  BITSET64 m = 0;
+  int l[MAXMOVES];
+  int n = findPossible(b, &m, l);
+  int d, i, j, p, try, best = 0;
+
+  newEngineSearch(b);
+  orderMoves(b, l, n, TT_NOMOVE, 0, 0);
+  for (d = 1; d <= depth; d++) {
+    best = MINSCORE-1;
+    j = 0;
+    for (i = 0; i < n; i++) {
+      if (i == 0)
+	try = alphaBeta(l[i], d, 0, best, MAXSCORE);
+      else
+	try = scout(l[i], d, 0, best, MAXSCORE);
+      if (try > best) {
+	best = try;
+	j = i;
+      }
+    }
+    p = l[j];
+    for (i = j; i > 0; i--)
+      l[i] = l[i-1];
+    l[0] = p;
+  }
+  *move = l[0];
+  return max(-MAXPOS, min(MAXPOS, best / PIECEVAL));
+}
+
+/*
+ *  engine_solve - returns the final score of position, b, with perfect
+ *                 play and assigns the best move to, move.
+ */
+
+int engine_solve (board b, int *move)
+{
+  BITSET64 m = 0;
+  int l[MAXMOVES];
+  int n = findPossible(b, &m, l);
+
+  newEngineSearch(b);
+  return solveRoot(move, l, n, b, MINSCORE, MAXSCORE) / PIECEVAL;
+}
+
+/*
+ *  engine_explored - returns the number of positions this thread has
+ *                    evaluated since the last call.
+ */
+
+int engine_explored (void)
+{
+  int explored = positionsExplored;
+
+  positionsExplored = 0;
+  return explored;
+}
+
+#else
+/*
+ *  usage - display the command line options and exit.
+ */
+
+static void usage (char *name)
+{
+  printf("usage: %s [-s seconds] [-t megabytes] [-M depth] [-E empties] [-R empties]\n"
+	 "       [-W discs] [-p weights] [-F terms] [-T] [-L] [-H] [-N]\n"
+	 "       [-A affinity] [-P processors]\n", name);
+  printf("  -s seconds     time allowed for each computer move (default %d)\n",
+	 timePerMove);
+  printf("  -t megabytes   size of the transposition table (default %d)\n",
+	 TTABLE_DEFAULT_MB);
+  printf("  -M depth       order moves by the opponent's mobility with at least\n"
+	 "                 this many plies left, 0 never (default %d)\n", MOBILITYDEPTH);
+  printf("  -E empties     solve the end of the game exactly with this many empty\n"
+	 "                 squares left (default %d)\n", ENDGAMEEMPTIES);
+  printf("  -R empties     solve for a win, loss or draw with this many empty\n"
+	 "                 squares left (default %d)\n", WLDEMPTIES);
+  printf("  -W discs       search the root with a window this wide either side\n"
+	 "                 of the last score, 0 for the full width (default %d)\n",
+	 ASPIRATION);
+  printf("  -p weights     evaluate with the pattern weights in this file rather\n"
+	 "                 than %s, if present, or the disc count\n",
+	 PATTERN_DEFAULT_FILE);
+  printf("  -F terms       weigh the stable discs, frontier discs and potential\n"
+	 "                 mobility, as in 128,32,16, in 1/%d discs (default 0,0,0)\n",
+	 PATTERN_SCALE);
+  printf("  -T             search with threads rather than processes\n");
+  printf("  -L             Lazy SMP search rather than young brothers wait\n");
+  printf("  -H             place the shared memory on huge pages\n");
+  printf("  -N             interleave the shared memory over the NUMA nodes\n");
+  printf("  -A affinity    pin the searchers compact, scatter or to a list of\n"
+	 "                 processors such as 0,2,4-7\n");
+  printf("  -P processors  search with this many processors rather than those\n"
+	 "                 allowed by our cpuset and cgroup cpu quota\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  int s, f;
+  int opt;
+
+  if (sizeof(BITSET64) != 8) {
+    printf("BITSET64 must be 64 bits in length\n");
+	exit(1);
+  }
+
+  while ((opt = getopt(argc, argv, "s:t:M:E:R:W:p:F:TLHNA:P:")) != -1) {
+    switch (opt) {
+    case 's':
+      timePerMove = atoi(optarg);
+      if (timePerMove <= 0)
+	usage(argv[0]);
+      break;
+    case 't':
+      tableSize = atoi(optarg);
+      if (tableSize == 0)
+	usage(argv[0]);
+      break;
+    case 'M':
+      mobilityDepth = atoi(optarg);
+      if (mobilityDepth < 0)
+	usage(argv[0]);
+      break;
+    case 'E':
+      endgameEmpties = atoi(optarg);
+      if (endgameEmpties < 0)
+	usage(argv[0]);
+      break;
+    case 'R':
+      wldEmpties = atoi(optarg);
+      if (wldEmpties < 0)
+	usage(argv[0]);
+      break;
+    case 'W':
+      aspiration = atoi(optarg) * PIECEVAL;
+      if (aspiration < 0)
+	usage(argv[0]);
+      break;
+    case 'p':
+      weights = optarg;
+      break;
+    case 'F':
+      if (sscanf(optarg, "%d,%d,%d",
+		 &stableWeight, &frontierWeight, &potentialWeight) != 3)
+	usage(argv[0]);
+      break;
+#if !defined(SEQUENTIAL)
+    case 'T':
+      useThreads = TRUE;
+      break;
+    case 'L':
+      lazySMP = TRUE;
+      break;
+    case 'H':
+      hugePages = TRUE;
+      break;
+    case 'N':
+      interleave = TRUE;
+      break;
+    case 'A':
+      affinity = optarg;
+      break;
+    case 'P':
+      processors = atoi(optarg);
+      if (processors <= 0)
+	usage(argv[0]);
+      break;
+#endif
+    default:
+      usage(argv[0]);
+    }
+  }
+
+#if !defined(SEQUENTIAL)
+  if (useThreads)
+    multiprocessor_useThreads ();
+  if (hugePages)
+    multiprocessor_useHugePages ();
+  if (interleave)
+    multiprocessor_useInterleave ();
+  if (affinity != NULL)
+    multiprocessor_setAffinity (affinity);
+  if (processors > 0)
+    multiprocessor_setProcessors (processors);
+#endif
+  if (weights != NULL) {
+    if (! pattern_load(weights)) {
+      printf("unable to open the pattern weights %s\n", weights);
+      exit(1);
+    }
+  }
+  else if (pattern_load(PATTERN_DEFAULT_FILE))
+    weights = PATTERN_DEFAULT_FILE;
+  if (weights != NULL)
+    printf("evaluating positions with the pattern weights in %s\n", weights);
+  ttable_init(tableSize);
+#if !defined(SEQUENTIAL)
+  setupIPC ();
+  multiprocessor_reportPlacement ();
+#endif
+
+  // setupTest();
+  setup();
+
+  f = 0;
+  while (f != 2) {
+# if 1
+    if (humanMove(Colours, Used, 0))
+      f = 0;
+    else
+      f++;
+# else
+    if (computerMove(Colours, Used, 0))
+      f = 0;
+    else
+      f++;
+# endif
+    if (f == 2)
+      break;
+    if (computerMove(Colours, Used, 1))
+      f = 0;
+    else
+      f++;
+  }
+  printf("end of the game and ");
+  s = finalScore(Colours, Used);
+  if (s < 0)
+    printf("you beat me by %d tiles\n", -s);
+  if (s > 0)
+    printf("I won by %d tiles\n", s);
+  if (s == 0)
+    printf("the result is a draw\n");
+#if !defined(SEQUENTIAL)
+  finishIPC ();
+#endif
+  return 0;
+}
+#endif
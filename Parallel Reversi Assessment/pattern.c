@@ -0,0 +1,466 @@
+#define pattern_c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pattern.h"
+
+#if !defined(TRUE)
+#  define TRUE (1==1)
+#endif
+
+#if !defined(FALSE)
+#  define FALSE (1==0)
+#endif
+
+#define MAGIC            "RWTS"
+#define VERSION          1
+#define MAXPLACES       16   /* instances a square may belong to.  */
+
+/*
+ *  A weights file holds, in the byte order of the host:
+ *
+ *    char      magic[4]                 "RWTS"
+ *    uint32    version                  1
+ *    uint32    stages                   PATTERN_STAGES
+ *    uint32    families                 PATTERN_FAMILIES
+ *    uint32    size[families]           3 to the power of its squares
+ *    int16     weight[stages][families][size]
+ *
+ *  The weights are seen from the side to move, whose discs have the
+ *  code 1 in the index.
+ */
+
+typedef struct family_t {
+  const char *name;
+  int squares;
+  int square[PATTERN_MAXSIZE];   /* in the orientation of the a1 corner.  */
+} family;
+
+static const family families[PATTERN_FAMILIES] = {
+  { "edge",      10, { 0, 1, 2, 3, 4, 5, 6, 7, 9, 14 } },  /* with both X squares.  */
+  { "corner3x3",  9, { 0, 1, 2, 8, 9, 10, 16, 17, 18 } },
+  { "corner2x5", 10, { 0, 1, 2, 3, 4, 8, 9, 10, 11, 12 } },
+  { "row2",       8, { 8, 9, 10, 11, 12, 13, 14, 15 } },
+  { "row3",       8, { 16, 17, 18, 19, 20, 21, 22, 23 } },
+  { "row4",       8, { 24, 25, 26, 27, 28, 29, 30, 31 } },
+  { "diagonal8",  8, { 0, 9, 18, 27, 36, 45, 54, 63 } },
+  { "diagonal7",  7, { 1, 10, 19, 28, 37, 46, 55 } },
+  { "diagonal6",  6, { 2, 11, 20, 29, 38, 47 } },
+  { "diagonal5",  5, { 3, 12, 21, 30, 39 } },
+  { "diagonal4",  4, { 4, 13, 22, 31 } },
+  { "bias",       0, { 0 } },
+};
+
+typedef struct place_t {
+  unsigned short instance;
+  unsigned short power;          /* of 3 given to the square in the index.  */
+} place;
+
+static int instanceFamily[PATTERN_INSTANCES];
+static int instanceSquare[PATTERN_INSTANCES][PATTERN_MAXSIZE];
+static int noOfInstances = 0;
+static place places[MAXPOS][MAXPLACES];
+static int noOfPlaces[MAXPOS];
+static int size[PATTERN_FAMILIES];
+static int initialised = FALSE;
+
+/* weight[code][stage][family] is indexed by the pattern seen with the
+   side to move holding, code.  */
+static short *weight[2][PATTERN_STAGES][PATTERN_FAMILIES];
+static int isLoaded = FALSE;
+
+
+/*
+ *  symmetry - return square, p, under the symmetry, s, of the board,
+ *             s being 0..7.  Bit 0 reflects the columns, bit 1 the
+ *             rows and bit 2 the diagonal.
+ */
+
+static int symmetry (int p, int s)
+{
+  int x = p % MAXX;
+  int y = p / MAXX;
+  int t;
+
+  if (s & 1)
+    x = MAXX-1 - x;
+  if (s & 2)
+    y = MAXY-1 - y;
+  if (s & 4)
+    {
+      t = x;
+      x = y;
+      y = t;
+    }
+  return y * MAXX + x;
+}
+
+
+/*
+ *  squareSet - return the set of squares of the instance, i.
+ */
+
+static BITSET64 squareSet (int i)
+{
+  BITSET64 set = 0;
+  int k;
+
+  for (k = 0; k < families[instanceFamily[i]].squares; k++)
+    set |= ((BITSET64) 1) << instanceSquare[i][k];
+  return set;
+}
+
+
+/*
+ *  init - create the instances of every family, one for each symmetry
+ *         which covers a different set of squares, and note which
+ *         instances each square belongs to.
+ */
+
+static void init (void)
+{
+  const family *f;
+  BITSET64 set;
+  int fam, s, k, i, p, power, duplicate;
+
+  if (initialised)
+    return;
+  for (fam = 0; fam < PATTERN_FAMILIES; fam++)
+    {
+      f = &families[fam];
+      size[fam] = 1;
+      for (k = 0; k < f->squares; k++)
+	size[fam] *= 3;
+      for (s = 0; s < 8; s++)
+	{
+	  set = 0;
+	  for (k = 0; k < f->squares; k++)
+	    set |= ((BITSET64) 1) << symmetry (f->square[k], s);
+	  duplicate = FALSE;
+	  for (i = 0; i < noOfInstances; i++)
+	    if (instanceFamily[i] == fam && squareSet (i) == set)
+	      duplicate = TRUE;
+	  if (duplicate)
+	    continue;
+	  if (noOfInstances == PATTERN_INSTANCES)
+	    {
+	      printf ("PATTERN_INSTANCES is too small\n");
+	      exit (1);
+	    }
+	  instanceFamily[noOfInstances] = fam;
+	  for (k = 0; k < f->squares; k++)
+	    instanceSquare[noOfInstances][k] = symmetry (f->square[k], s);
+	  noOfInstances++;
+	}
+    }
+  if (noOfInstances != PATTERN_INSTANCES)
+    {
+      printf ("PATTERN_INSTANCES should be %d\n", noOfInstances);
+      exit (1);
+    }
+
+  for (p = 0; p < MAXPOS; p++)
+    noOfPlaces[p] = 0;
+  for (i = 0; i < noOfInstances; i++)
+    {
+      power = 1;
+      for (k = 0; k < families[instanceFamily[i]].squares; k++)
+	{
+	  p = instanceSquare[i][k];
+	  if (noOfPlaces[p] == MAXPLACES)
+	    {
+	      printf ("MAXPLACES is too small\n");
+	      exit (1);
+	    }
+	  places[p][noOfPlaces[p]].instance = i;
+	  places[p][noOfPlaces[p]].power = power;
+	  noOfPlaces[p]++;
+	  power *= 3;
+	}
+    }
+  initialised = TRUE;
+}
+
+
+/*
+ *  swapColours - return the index, index, of a pattern of, squares,
+ *                with the codes 1 and 2 exchanged.
+ */
+
+static int swapColours (int index, int squares)
+{
+  int swapped = 0;
+  int power = 1;
+  int k, code;
+
+  for (k = 0; k < squares; k++)
+    {
+      code = index % 3;
+      index /= 3;
+      if (code != 0)
+	code = 3 - code;
+      swapped += code * power;
+      power *= 3;
+    }
+  return swapped;
+}
+
+
+/*
+ *  readWord - return the next 32 bit word from file, f, which is
+ *             called, filename.
+ */
+
+static unsigned int readWord (FILE *f, const char *filename)
+{
+  unsigned int w;
+
+  if (fread (&w, sizeof (w), 1, f) != 1)
+    {
+      printf ("%s is too short to be a weights file\n", filename);
+      exit (1);
+    }
+  return w;
+}
+
+
+/*
+ *  load - read the weights from the file, filename.  FALSE is
+ *         returned if the file cannot be opened, a file which is not
+ *         a weights file for these patterns is an error.
+ */
+
+int pattern_load (const char *filename)
+{
+  FILE *f = fopen (filename, "rb");
+  char magic[4];
+  int stage, fam, i;
+  short *w;
+
+  if (f == NULL)
+    return FALSE;
+  init ();
+  if (fread (magic, sizeof (magic), 1, f) != 1
+      || memcmp (magic, MAGIC, sizeof (magic)) != 0
+      || readWord (f, filename) != VERSION
+      || readWord (f, filename) != PATTERN_STAGES
+      || readWord (f, filename) != PATTERN_FAMILIES)
+    {
+      printf ("%s is not a weights file for these patterns\n", filename);
+      exit (1);
+    }
+  for (fam = 0; fam < PATTERN_FAMILIES; fam++)
+    if (readWord (f, filename) != (unsigned int) size[fam])
+      {
+	printf ("%s has weights for different patterns\n", filename);
+	exit (1);
+      }
+
+  for (stage = 0; stage < PATTERN_STAGES; stage++)
+    for (fam = 0; fam < PATTERN_FAMILIES; fam++)
+      {
+	w = (short *) malloc (2 * size[fam] * sizeof (short));
+	if (w == NULL)
+	  {
+	    printf ("unable to allocate the pattern weights\n");
+	    exit (1);
+	  }
+	if (fread (w, sizeof (short), size[fam], f) != (size_t) size[fam])
+	  {
+	    printf ("%s is too short to be a weights file\n", filename);
+	    exit (1);
+	  }
+	/* and again for when the side to move has the code 2 */
+	for (i = 0; i < size[fam]; i++)
+	  w[size[fam] + i] = w[swapColours (i, families[fam].squares)];
+	weight[0][stage][fam] = w;
+	weight[1][stage][fam] = w + size[fam];
+      }
+  fclose (f);
+  isLoaded = TRUE;
+  return TRUE;
+}
+
+
+/*
+ *  writeWord - write the 32 bit word, w, to file, f.
+ */
+
+static void writeWord (FILE *f, unsigned int w)
+{
+  fwrite (&w, sizeof (w), 1, f);
+}
+
+
+/*
+ *  save - write the weights, table, to the file, filename.  table
+ *         holds the weights of each stage and family in the order of
+ *         the file, for the side to move holding the code 1.
+ */
+
+void pattern_save (const char *filename, short *table)
+{
+  FILE *f = fopen (filename, "wb");
+  int stage, fam;
+
+  if (f == NULL)
+    {
+      printf ("unable to create the weights file %s\n", filename);
+      exit (1);
+    }
+  init ();
+  fwrite (MAGIC, strlen (MAGIC), 1, f);
+  writeWord (f, VERSION);
+  writeWord (f, PATTERN_STAGES);
+  writeWord (f, PATTERN_FAMILIES);
+  for (fam = 0; fam < PATTERN_FAMILIES; fam++)
+    writeWord (f, size[fam]);
+  for (stage = 0; stage < PATTERN_STAGES; stage++)
+    for (fam = 0; fam < PATTERN_FAMILIES; fam++)
+      {
+	fwrite (table, sizeof (short), size[fam], f);
+	table += size[fam];
+      }
+  if (fclose (f) != 0)
+    {
+      printf ("unable to write the weights file %s\n", filename);
+      exit (1);
+    }
+}
+
+
+/*
+ *  table - copy the weights loaded into, table, in the order used by
+ *          save.
+ */
+
+void pattern_table (short *table)
+{
+  int stage, fam;
+
+  for (stage = 0; stage < PATTERN_STAGES; stage++)
+    for (fam = 0; fam < PATTERN_FAMILIES; fam++)
+      {
+	memcpy (table, weight[0][stage][fam], size[fam] * sizeof (short));
+	table += size[fam];
+      }
+}
+
+
+/*
+ *  family - return the family of the instance, i.
+ */
+
+int pattern_family (int i)
+{
+  init ();
+  return instanceFamily[i];
+}
+
+
+/*
+ *  size - return the number of weights of the family, fam, in each
+ *         stage.
+ */
+
+int pattern_size (int fam)
+{
+  init ();
+  return size[fam];
+}
+
+
+/*
+ *  loaded - return TRUE if weights have been loaded.
+ */
+
+int pattern_loaded (void)
+{
+  return isLoaded;
+}
+
+
+/*
+ *  compute - assign, p, with the index of every instance for position,
+ *            b, where the side to move has the code, mover.
+ */
+
+void pattern_compute (board b, int mover, patterns *p)
+{
+  int i, k, sq, code;
+
+  init ();
+  for (i = 0; i < PATTERN_INSTANCES; i++)
+    {
+      p->index[i] = 0;
+      for (k = families[instanceFamily[i]].squares - 1; k >= 0; k--)
+	{
+	  sq = instanceSquare[i][k];
+	  code = 0;
+	  if ((b.player >> sq) & 1)
+	    code = mover;
+	  else if ((b.opponent >> sq) & 1)
+	    code = 3 - mover;
+	  p->index[i] = p->index[i] * 3 + code;
+	}
+    }
+}
+
+
+/*
+ *  play - update the indices, p, as the side with the code, mover,
+ *         places a disc on, square, turning over the discs in, flips.
+ */
+
+void pattern_play (patterns *p, int mover, int square, BITSET64 flips)
+{
+  int delta = (mover == 1) ? -1 : 1;  /* each flip turns 3-mover into mover.  */
+  place *pl;
+  int k, sq;
+
+  for (k = 0, pl = places[square]; k < noOfPlaces[square]; k++, pl++)
+    p->index[pl->instance] += mover * pl->power;
+  while (flips != 0)
+    {
+      sq = board_lowestBit (flips);
+      flips &= flips-1;
+      for (k = 0, pl = places[sq]; k < noOfPlaces[sq]; k++, pl++)
+	p->index[pl->instance] += delta * pl->power;
+    }
+}
+
+
+/*
+ *  stage - return the stage of the game with, discs, on the board.
+ */
+
+int pattern_stage (int discs)
+{
+  int stage = (discs - 4) * PATTERN_STAGES / (MAXPOS - 3);
+
+  if (stage < 0)
+    return 0;
+  if (stage >= PATTERN_STAGES)
+    return PATTERN_STAGES-1;
+  return stage;
+}
+
+
+/*
+ *  evaluate - return the score in 1/PATTERN_SCALE discs of the position
+ *             with the indices, p, and, discs, discs on the board, seen
+ *             from the side with the code, mover.
+ */
+
+int pattern_evaluate (patterns *p, int mover, int discs)
+{
+  short **w = weight[mover-1][pattern_stage (discs)];
+  int score = 0;
+  int i;
+
+  for (i = 0; i < PATTERN_INSTANCES; i++)
+    score += w[instanceFamily[i]][p->index[i]];
+  return score;
+}
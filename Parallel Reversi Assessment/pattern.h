@@ -0,0 +1,126 @@
+/*  pattern.h provides a pattern based evaluation of a position.  The
+ *  board is covered by instances of a few pattern families (edges,
+ *  corners and diagonals) under each symmetry of the board.  Each
+ *  instance is indexed by the contents of its squares as a base 3
+ *  number and the index selects a weight learnt for that family and
+ *  the stage of the game.  The indices may be kept up to date as moves
+ *  are played rather than computed afresh for each position.
+ *
+ *  A square holds 0 if it is empty and otherwise the colour code, 1 or
+ *  2, of its disc.  The codes are fixed for a search rather than
+ *  following the side to move, so mover says which code the side to
+ *  move has.
+ */
+
+#if !defined(pattern_h)
+#  define pattern_h
+#  if defined(pattern_c)
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN
+#     endif /* !__GNUG__.  */
+#  else /* !pattern_c.  */
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN extern
+#     endif /* !__GNUG__.  */
+#  endif /* !pattern_c.  */
+
+#include "board.h"
+
+#define PATTERN_DEFAULT_FILE  "reversi.weights"
+
+#define PATTERN_FAMILIES    12   /* including the bias, which has no squares.  */
+#define PATTERN_INSTANCES   47   /* the families under every symmetry.  */
+#define PATTERN_STAGES      12   /* weights are learnt for each stage of the game.  */
+#define PATTERN_SCALE      128   /* weights are in 1/128ths of a disc.  */
+#define PATTERN_MAXSIZE     10   /* squares in the largest family.  */
+
+typedef struct patterns_t {
+  unsigned short index[PATTERN_INSTANCES];
+} patterns;
+
+
+/*
+ *  load - read the weights from the file, filename.  FALSE is
+ *         returned if the file cannot be opened, a file which is not
+ *         a weights file for these patterns is an error.
+ */
+
+EXTERN int pattern_load (const char *filename);
+
+
+/*
+ *  save - write the weights, table, to the file, filename.  table
+ *         holds the weights of each stage and family in the order of
+ *         the file, for the side to move holding the code 1.
+ */
+
+EXTERN void pattern_save (const char *filename, short *table);
+
+
+/*
+ *  table - copy the weights loaded into, table, in the order used by
+ *          save.
+ */
+
+EXTERN void pattern_table (short *table);
+
+
+/*
+ *  family - return the family of the instance, i.
+ */
+
+EXTERN int pattern_family (int i);
+
+
+/*
+ *  size - return the number of weights of the family, fam, in each
+ *         stage.
+ */
+
+EXTERN int pattern_size (int fam);
+
+
+/*
+ *  loaded - return TRUE if weights have been loaded.
+ */
+
+EXTERN int pattern_loaded (void);
+
+
+/*
+ *  compute - assign, p, with the index of every instance for position,
+ *            b, where the side to move has the code, mover.
+ */
+
+EXTERN void pattern_compute (board b, int mover, patterns *p);
+
+
+/*
+ *  play - update the indices, p, as the side with the code, mover,
+ *         places a disc on, square, turning over the discs in, flips.
+ */
+
+EXTERN void pattern_play (patterns *p, int mover, int square, BITSET64 flips);
+
+
+/*
+ *  evaluate - return the score in 1/PATTERN_SCALE discs of the position
+ *             with the indices, p, and, discs, discs on the board, seen
+ *             from the side with the code, mover.
+ */
+
+EXTERN int pattern_evaluate (patterns *p, int mover, int discs);
+
+
+/*
+ *  stage - return the stage of the game with, discs, on the board.
+ */
+
+EXTERN int pattern_stage (int discs);
+
+#  undef EXTERN
+#endif /* !pattern_h.  */
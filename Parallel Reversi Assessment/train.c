@@ -0,0 +1,520 @@
+/*  train.c fits the pattern weights which evaluate in paro64bit.c
+ *  loads.  Positions are taken from games the engine plays against
+ *  itself and each is labelled either with the result of its game,
+ *  whose end is solved and played perfectly, or with the score of a
+ *  deeper search.  The weights of every stage are then fitted to the
+ *  labels by least squares using gradient descent and written to the
+ *  weights file.  Both the games and the fitting are shared among one
+ *  thread for each processor we may use.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "board.h"
+#include "ttable.h"
+#include "pattern.h"
+#include "engine.h"
+#include "multiprocessor.h"
+
+#if !defined(TRUE)
+#  define TRUE (1==1)
+#endif
+
+#if !defined(FALSE)
+#  define FALSE (1==0)
+#endif
+
+#define GAMES            1000   /* default games played.  */
+#define OPENING            10   /* default plies played at random to begin each game.  */
+#define DEPTH               4   /* default depth of the searches choosing moves.  */
+#define EXPLORE             5   /* default percentage of moves played at random.  */
+#define SOLVEEMPTIES       14   /* default empty squares from which games are solved.  */
+#define EPOCHS            300   /* default passes of gradient descent.  */
+#define RATE              1.0   /* share of the residual corrected by each pass.  */
+#define SHRINK              4   /* occurrences before a weight moves at the full rate.  */
+#define REPORT             25   /* epochs between reports of the error.  */
+#define TABLEMB            64   /* default megabytes of transposition table.  */
+#define NOLABEL     (MAXPOS+1)   /* score of a position not yet labelled.  */
+
+typedef struct sample_t {
+  board position;       /* seen from the side to move.  */
+  int score;            /* label in discs for the side to move.  */
+} sample;
+
+typedef struct worker_t {
+  pthread_t thread;
+  int id;
+  sample *samples;      /* found by this worker.  */
+  int noOfSamples;
+  int maxSamples;
+  int from, to;         /* slice of the samples and weights we fit.  */
+  int weightsFrom, weightsTo;
+  float *gradient;      /* summed residual of each weight over our slice.  */
+  double error;         /* summed squared residual over our slice.  */
+} worker;
+
+typedef struct feature_t {
+  patterns p;
+  unsigned char stage;
+  float score;
+} feature;
+
+static int games = GAMES;
+static int opening = OPENING;
+static int depth = DEPTH;
+static int explore = EXPLORE;
+static int solveEmpties = SOLVEEMPTIES;
+static int labelDepth = 0;      /* 0 labels positions with the result of their game.  */
+static int epochs = EPOCHS;
+static unsigned int tableSize = TABLEMB;
+static unsigned int seed = 1;
+static char *weights = NULL;    /* weights searched with and fitted from.  */
+static char *output = PATTERN_DEFAULT_FILE;
+
+static int noWorkers;
+static worker *workers;
+static volatile int nextGame = 0;
+static pthread_barrier_t barrier;
+
+static feature *features;
+static int noOfFeatures = 0;
+static int family[PATTERN_INSTANCES];
+static int offset[PATTERN_STAGES][PATTERN_FAMILIES];  /* of each table in weight.  */
+static int noOfWeights = 0;
+static double *weight;
+static int *count;             /* occurrences of each weight in the features.  */
+
+
+/*
+ *  randomMove - returns a square chosen at random from the moves, m.
+ */
+
+static int randomMove (BITSET64 m, unsigned int *state)
+{
+  int n = rand_r(state) % board_popCount(m);
+
+  while (n > 0) {
+    m &= m-1;
+    n--;
+  }
+  return board_lowestBit(m);
+}
+
+/*
+ *  addSample - appends position, b, and its score to those found by
+ *              worker, w.
+ */
+
+static void addSample (worker *w, board b, int score)
+{
+  if (w->noOfSamples == w->maxSamples) {
+    w->maxSamples = w->maxSamples * 2 + MAXPOS;
+    w->samples = (sample *) realloc(w->samples, w->maxSamples * sizeof(sample));
+    if (w->samples == NULL) {
+      printf("unable to allocate the samples\n");
+      exit(1);
+    }
+  }
+  w->samples[w->noOfSamples].position = b;
+  w->samples[w->noOfSamples].score = score;
+  w->noOfSamples++;
+}
+
+/*
+ *  playGame - the engine plays game, number, against itself and the
+ *             positions in which the side to move has a choice are
+ *             added to the samples of worker, w.  Once no more than
+ *             solveEmpties squares are empty each move is solved, so
+ *             the result of the game is exact from there on.
+ */
+
+static void playGame (worker *w, int number)
+{
+  unsigned int state = seed * 1000003U + number;
+  board record[MAXPOS];
+  int side[MAXPOS];             /* ply & 1 of each position recorded.  */
+  int exact[MAXPOS];            /* score of each position solved.  */
+  board b;
+  BITSET64 m;
+  int recorded = 0, ply = 0, passed = FALSE;
+  int move, score, empties, d, i;
+
+  b.player = 0x0000000810000000ULL;
+  b.opponent = 0x0000001008000000ULL;
+  for (;;) {
+    m = board_legalMoves(b);
+    if (m == 0) {
+      if (passed)
+	break;
+      passed = TRUE;
+      b = board_swap(b);
+      ply++;
+      continue;
+    }
+    passed = FALSE;
+    empties = MAXPOS - board_popCount(b.player | b.opponent);
+    record[recorded] = b;
+    side[recorded] = ply & 1;
+    exact[recorded] = NOLABEL;
+    if (empties <= solveEmpties)
+      exact[recorded] = engine_solve(b, &move);
+    else if (ply < opening || (int) (rand_r(&state) % 100) < explore)
+      move = randomMove(m, &state);
+    else
+      engine_search(b, depth, &move);
+    recorded++;
+    b = board_swap(board_play(b, move, board_flipMask(b, move)));
+    ply++;
+  }
+
+  /* the result of the game for the side to move at its end */
+  d = board_popCount(b.player) - board_popCount(b.opponent);
+  empties = MAXPOS - board_popCount(b.player | b.opponent);
+  if (d > 0)
+    d += empties;
+  else if (d < 0)
+    d -= empties;
+
+  for (i = 0; i < recorded; i++) {
+    if (exact[i] != NOLABEL)
+      score = exact[i];
+    else if (labelDepth > 0)
+      score = engine_search(record[i], labelDepth, &move);
+    else if (side[i] == (ply & 1))
+      score = d;
+    else
+      score = -d;
+    addSample(w, record[i], score);
+  }
+}
+
+/*
+ *  playGames - plays games, for worker, arg, until enough have been
+ *              played.
+ */
+
+static void *playGames (void *arg)
+{
+  worker *w = (worker *) arg;
+  int number;
+
+  while ((number = __sync_fetch_and_add(&nextGame, 1)) < games) {
+    playGame(w, number);
+    if ((number + 1) % 100 == 0)
+      printf("played %d games\n", number + 1);
+  }
+  return NULL;
+}
+
+/*
+ *  weightOf - returns the index in weight of instance, i, of feature, f.
+ */
+
+static __inline__ int weightOf (feature *f, int i)
+{
+  return offset[f->stage][family[i]] + f->p.index[i];
+}
+
+/*
+ *  makeFeatures - gathers the samples of every worker and computes
+ *                 their pattern indices, seen from the side to move,
+ *                 together with the occurrences of each weight.
+ */
+
+static void makeFeatures (void)
+{
+  sample *s;
+  feature *f;
+  int i, j, k;
+
+  for (i = 0; i < noWorkers; i++)
+    noOfFeatures += workers[i].noOfSamples;
+  features = (feature *) malloc(noOfFeatures * sizeof(feature));
+  count = (int *) calloc(noOfWeights, sizeof(int));
+  if (features == NULL || count == NULL) {
+    printf("unable to allocate the features\n");
+    exit(1);
+  }
+  f = features;
+  for (i = 0; i < noWorkers; i++) {
+    for (j = 0, s = workers[i].samples; j < workers[i].noOfSamples; j++, s++, f++) {
+      pattern_compute(s->position, 1, &f->p);
+      f->stage = pattern_stage(board_popCount(s->position.player | s->position.opponent));
+      f->score = s->score;
+      for (k = 0; k < PATTERN_INSTANCES; k++)
+	count[weightOf(f, k)]++;
+    }
+    free(workers[i].samples);
+  }
+}
+
+/*
+ *  fitWeights - performs, epochs, passes of gradient descent for worker,
+ *               arg.  Each pass the worker sums the residuals of its
+ *               slice of the features into its own gradient, and once
+ *               every worker has done so, moves its slice of the
+ *               weights by the mean residual over all the workers.
+ */
+
+static void *fitWeights (void *arg)
+{
+  worker *w = (worker *) arg;
+  feature *f;
+  double predicted, residual, error;
+  float sum;
+  int e, i, j, k;
+
+  for (e = 1; e <= epochs; e++) {
+    memset(w->gradient, 0, noOfWeights * sizeof(float));
+    w->error = 0.0;
+    for (i = w->from, f = &features[w->from]; i < w->to; i++, f++) {
+      predicted = 0.0;
+      for (k = 0; k < PATTERN_INSTANCES; k++)
+	predicted += weight[weightOf(f, k)];
+      residual = f->score - predicted;
+      w->error += residual * residual;
+      for (k = 0; k < PATTERN_INSTANCES; k++)
+	w->gradient[weightOf(f, k)] += residual;
+    }
+    pthread_barrier_wait(&barrier);
+
+    for (k = w->weightsFrom; k < w->weightsTo; k++) {
+      sum = 0.0;
+      for (j = 0; j < noWorkers; j++)
+	sum += workers[j].gradient[k];
+      weight[k] += RATE * sum / ((count[k] + SHRINK) * PATTERN_INSTANCES);
+    }
+    if (w->id == 0 && (e % REPORT == 0 || e == 1)) {
+      error = 0.0;
+      for (j = 0; j < noWorkers; j++)
+	error += workers[j].error;
+      printf("epoch %d root mean square error %.3f discs\n",
+	     e, sqrt(error / noOfFeatures));
+    }
+    pthread_barrier_wait(&barrier);
+  }
+  return NULL;
+}
+
+/*
+ *  saveWeights - writes the weights, in 1/PATTERN_SCALE discs, to the
+ *                file, output.
+ */
+
+static void saveWeights (void)
+{
+  short *table = (short *) malloc(noOfWeights * sizeof(short));
+  double v;
+  int k;
+
+  if (table == NULL) {
+    printf("unable to allocate the weights\n");
+    exit(1);
+  }
+  for (k = 0; k < noOfWeights; k++) {
+    v = floor(weight[k] * PATTERN_SCALE + 0.5);
+    if (v > 32767)
+      v = 32767;
+    if (v < -32767)
+      v = -32767;
+    table[k] = (short) v;
+  }
+  pattern_save(output, table);
+  free(table);
+}
+
+/*
+ *  initWeights - lays out the weights of every stage and family as in
+ *                the weights file, starting from those loaded, if any.
+ */
+
+static void initWeights (void)
+{
+  short *table;
+  int stage, fam, k;
+
+  for (k = 0; k < PATTERN_INSTANCES; k++)
+    family[k] = pattern_family(k);
+  for (stage = 0; stage < PATTERN_STAGES; stage++)
+    for (fam = 0; fam < PATTERN_FAMILIES; fam++) {
+      offset[stage][fam] = noOfWeights;
+      noOfWeights += pattern_size(fam);
+    }
+  weight = (double *) calloc(noOfWeights, sizeof(double));
+  if (weight == NULL) {
+    printf("unable to allocate the weights\n");
+    exit(1);
+  }
+  if (pattern_loaded()) {
+    table = (short *) malloc(noOfWeights * sizeof(short));
+    if (table == NULL) {
+      printf("unable to allocate the weights\n");
+      exit(1);
+    }
+    pattern_table(table);
+    for (k = 0; k < noOfWeights; k++)
+      weight[k] = (double) table[k] / PATTERN_SCALE;
+    free(table);
+  }
+}
+
+/*
+ *  runWorkers - runs, fn, in every worker and waits for them all.
+ */
+
+static void runWorkers (void *(*fn) (void *))
+{
+  int i;
+
+  for (i = 0; i < noWorkers; i++)
+    if (pthread_create(&workers[i].thread, NULL, fn, &workers[i]) != 0) {
+      printf("unable to create a training thread\n");
+      exit(1);
+    }
+  for (i = 0; i < noWorkers; i++)
+    pthread_join(workers[i].thread, NULL);
+}
+
+/*
+ *  usage - display the command line options and exit.
+ */
+
+static void usage (char *name)
+{
+  printf("usage: %s [-g games] [-o plies] [-d depth] [-x percent] [-e empties]\n"
+	 "       [-l depth] [-i epochs] [-j threads] [-t megabytes] [-r seed]\n"
+	 "       [-p weights] [-w file]\n", name);
+  printf("  -g games       games of self-play (default %d)\n", GAMES);
+  printf("  -o plies       plies played at random to begin each game (default %d)\n",
+	 OPENING);
+  printf("  -d depth       depth of the searches choosing moves (default %d)\n", DEPTH);
+  printf("  -x percent     percentage of later moves played at random (default %d)\n",
+	 EXPLORE);
+  printf("  -e empties     solve the games exactly with this many empty squares\n"
+	 "                 left (default %d)\n", SOLVEEMPTIES);
+  printf("  -l depth       label positions before the solved endgame with a search\n"
+	 "                 this deep rather than the result of their game\n");
+  printf("  -i epochs      passes of gradient descent (default %d)\n", EPOCHS);
+  printf("  -j threads     train with this many threads rather than one for each\n"
+	 "                 processor we may use\n");
+  printf("  -t megabytes   size of the transposition table (default %d)\n", TABLEMB);
+  printf("  -r seed        seed of the random moves (default 1)\n");
+  printf("  -p weights     search with these weights and fit from them\n");
+  printf("  -w file        write the weights to this file (default %s)\n",
+	 PATTERN_DEFAULT_FILE);
+  exit(1);
+}
+
+int main (int argc, char *argv[])
+{
+  int opt, i, n, threads = 0;
+
+  while ((opt = getopt(argc, argv, "g:o:d:x:e:l:i:j:t:r:p:w:")) != -1) {
+    switch (opt) {
+    case 'g':
+      games = atoi(optarg);
+      if (games <= 0)
+	usage(argv[0]);
+      break;
+    case 'o':
+      opening = atoi(optarg);
+      if (opening < 0)
+	usage(argv[0]);
+      break;
+    case 'd':
+      depth = atoi(optarg);
+      if (depth <= 0)
+	usage(argv[0]);
+      break;
+    case 'x':
+      explore = atoi(optarg);
+      if (explore < 0 || explore > 100)
+	usage(argv[0]);
+      break;
+    case 'e':
+      solveEmpties = atoi(optarg);
+      if (solveEmpties < 0)
+	usage(argv[0]);
+      break;
+    case 'l':
+      labelDepth = atoi(optarg);
+      if (labelDepth < 0)
+	usage(argv[0]);
+      break;
+    case 'i':
+      epochs = atoi(optarg);
+      if (epochs < 0)
+	usage(argv[0]);
+      break;
+    case 'j':
+      threads = atoi(optarg);
+      if (threads <= 0)
+	usage(argv[0]);
+      break;
+    case 't':
+      tableSize = atoi(optarg);
+      if (tableSize == 0)
+	usage(argv[0]);
+      break;
+    case 'r':
+      seed = atoi(optarg);
+      break;
+    case 'p':
+      weights = optarg;
+      break;
+    case 'w':
+      output = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+
+  if (weights != NULL && ! pattern_load(weights)) {
+    printf("unable to open the pattern weights %s\n", weights);
+    exit(1);
+  }
+  if (threads > 0)
+    multiprocessor_setProcessors(threads);
+  noWorkers = multiprocessor_maxProcessors();
+  workers = (worker *) calloc(noWorkers, sizeof(worker));
+  if (workers == NULL) {
+    printf("unable to allocate the training threads\n");
+    exit(1);
+  }
+  for (i = 0; i < noWorkers; i++)
+    workers[i].id = i;
+  ttable_init(tableSize);
+  ttable_newSearch();
+
+  printf("playing %d games with %d threads, searching %d plies and solving\n"
+	 "the last %d empty squares\n", games, noWorkers, depth, solveEmpties);
+  runWorkers(playGames);
+
+  initWeights();
+  makeFeatures();
+  printf("fitting %d weights to %d positions\n", noOfWeights, noOfFeatures);
+  n = noWorkers;
+  for (i = 0; i < n; i++) {
+    workers[i].from = (long long) noOfFeatures * i / n;
+    workers[i].to = (long long) noOfFeatures * (i + 1) / n;
+    workers[i].weightsFrom = (long long) noOfWeights * i / n;
+    workers[i].weightsTo = (long long) noOfWeights * (i + 1) / n;
+    workers[i].gradient = (float *) malloc(noOfWeights * sizeof(float));
+    if (workers[i].gradient == NULL) {
+      printf("unable to allocate the gradient\n");
+      exit(1);
+    }
+  }
+  pthread_barrier_init(&barrier, NULL, n);
+  runWorkers(fitWeights);
+
+  saveWeights();
+  printf("written the weights to %s\n", output);
+  return 0;
+}
@@ -0,0 +1,276 @@
+#define ttable_c
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ttable.h"
+
+#if !defined(SEQUENTIAL)
+#  include "multiprocessor.h"
+#endif
+
+#if !defined(TRUE)
+#  define TRUE (1==1)
+#endif
+
+#if !defined(FALSE)
+#  define FALSE (1==0)
+#endif
+
+#define SLOTS_PER_BUCKET  4   /* 4 slots of 16 bytes fill a cache line.  */
+
+/*
+ *  the data word of a slot is packed as follows:
+ *
+ *    bits  0..31  score
+ *    bits 32..39  move+1 (0 means no move)
+ *    bits 40..47  depth
+ *    bits 48..49  bound
+ *    bits 56..63  age of the search which stored the entry
+ */
+
+#define DATA_SCORE(D)     ((int) (unsigned int) ((D) & 0xffffffffULL))
+#define DATA_MOVE(D)      ((int) (((D) >> 32) & 0xff) - 1)
+#define DATA_DEPTH(D)     ((int) (((D) >> 40) & 0xff))
+#define DATA_BOUND(D)     ((int) (((D) >> 48) & 0x3))
+#define DATA_AGE(D)       ((unsigned int) (((D) >> 56) & 0xff))
+
+typedef struct slot_t {
+  BITSET64 key;    /* hash xor data, so a torn write never verifies.  */
+  BITSET64 data;
+} slot;
+
+typedef struct bucket_t {
+  slot s[SLOTS_PER_BUCKET];
+} bucket;
+
+typedef struct table_t {
+  unsigned int age;   /* incremented for every new search.  */
+  unsigned int pad[15];
+  bucket b[1];        /* the real number of buckets is mask+1.  */
+} table;
+
+static table *tt = NULL;
+static BITSET64 mask = 0;
+static BITSET64 zobrist[2*8][256];  /* hash of every byte value of each row.  */
+
+
+/*
+ *  random64 - return the next number from the splitmix64 sequence.
+ *             A fixed seed keeps every process in agreement.
+ */
+
+static BITSET64 random64 (BITSET64 *state)
+{
+  BITSET64 z = (*state += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+
+/*
+ *  initZobrist - give each square a random key for each side and
+ *                build the per row tables from them.
+ */
+
+static void initZobrist (void)
+{
+  BITSET64 state = 0x5265766572736921ULL;
+  BITSET64 square[2*8][8];
+  int row, v, bit;
+
+  for (row = 0; row < 2*8; row++)
+    for (bit = 0; bit < 8; bit++)
+      square[row][bit] = random64 (&state);
+
+  for (row = 0; row < 2*8; row++)
+    for (v = 0; v < 256; v++)
+      {
+	zobrist[row][v] = 0;
+	for (bit = 0; bit < 8; bit++)
+	  if (v & (1 << bit))
+	    zobrist[row][v] ^= square[row][bit];
+      }
+}
+
+
+/*
+ *  init - create a table of at most, megabytes, in size.  The number
+ *         of entries is rounded down to a power of two.  In the
+ *         parallel build the table is placed in shared memory so
+ *         that every search process uses the same table.
+ */
+
+void ttable_init (unsigned int megabytes)
+{
+  size_t available = ((size_t) megabytes) << 20;
+  size_t buckets = 1;
+  size_t size;
+
+  while (buckets * 2 * sizeof (bucket) + sizeof (table) <= available)
+    buckets *= 2;
+  size = sizeof (table) + (buckets - 1) * sizeof (bucket);
+#if defined(SEQUENTIAL)
+  tt = (table *) calloc (1, size);
+  if (tt == NULL)
+    {
+      printf ("unable to allocate the transposition table\n");
+      exit (1);
+    }
+#else
+  tt = (table *) multiprocessor_allocSharedMemory (size);
+#endif
+  mask = buckets - 1;
+  tt->age = 1;
+  initZobrist ();
+}
+
+
+/*
+ *  newSearch - age every entry in the table by one search.  Entries
+ *              from older searches are replaced in preference.
+ */
+
+void ttable_newSearch (void)
+{
+  tt->age = (tt->age % 255) + 1;  /* 1..255, an empty slot has age 0.  */
+}
+
+
+/*
+ *  hash - return the Zobrist hash of position, b.
+ */
+
+BITSET64 ttable_hash (board b)
+{
+  BITSET64 h = 0;
+  int row;
+
+  for (row = 0; row < 8; row++)
+    {
+      h ^= zobrist[row][(b.player >> (row*8)) & 0xff];
+      h ^= zobrist[8+row][(b.opponent >> (row*8)) & 0xff];
+    }
+  return h;
+}
+
+
+/*
+ *  hashMove - assign, hash, with the hash of the position after the
+ *             side to move plays on square, move, turning over the
+ *             discs in, flips, and, swapped, with the hash of it with
+ *             the sides swapped.  On entry they hold the same for the
+ *             position before the move.  As the hash of a set of
+ *             squares is the xor of the hashes of its rows, only the
+ *             rows the move changes are looked at.
+ */
+
+void ttable_hashMove (BITSET64 *hash, BITSET64 *swapped, int move, BITSET64 flips)
+{
+  BITSET64 placed = flips | (((BITSET64) 1) << move);
+  BITSET64 rows = placed;
+  BITSET64 h = 0;   /* changes seen from the side to move after the move.  */
+  BITSET64 s = 0;
+  BITSET64 before = *hash;
+  int row, f, p;
+
+  while (rows != 0)
+    {
+      row = board_lowestBit (rows) / 8;
+      rows &= ~(0xffULL << (row*8));
+      f = (flips >> (row*8)) & 0xff;
+      p = (placed >> (row*8)) & 0xff;
+      h ^= zobrist[row][f] ^ zobrist[8+row][p];
+      s ^= zobrist[row][p] ^ zobrist[8+row][f];
+    }
+  *hash = *swapped ^ h;
+  *swapped = before ^ s;
+}
+
+
+/*
+ *  probe - return TRUE if the position, hash, was found and assign
+ *          its contents to, e.
+ */
+
+int ttable_probe (BITSET64 hash, ttentry *e)
+{
+  bucket *b = &tt->b[hash & mask];
+  int i;
+
+  for (i = 0; i < SLOTS_PER_BUCKET; i++)
+    {
+      BITSET64 key = b->s[i].key;
+      BITSET64 data = b->s[i].data;
+
+      if ((key ^ data) == hash && DATA_BOUND (data) != TT_NONE)
+	{
+	  e->score = DATA_SCORE (data);
+	  e->move = DATA_MOVE (data);
+	  e->depth = DATA_DEPTH (data);
+	  e->bound = DATA_BOUND (data);
+	  return TRUE;
+	}
+    }
+  return FALSE;
+}
+
+
+/*
+ *  store - remember the result of searching position, hash.  The slot
+ *          already holding the position is overwritten, otherwise the
+ *          slot from the oldest search with the shallowest depth.
+ */
+
+void ttable_store (BITSET64 hash, int depth, int bound, int score, int move)
+{
+  bucket *b = &tt->b[hash & mask];
+  unsigned int age = tt->age;
+  int victim = 0;
+  int lowest = -1;
+  BITSET64 data;
+  int i;
+
+  for (i = 0; i < SLOTS_PER_BUCKET; i++)
+    {
+      BITSET64 old = b->s[i].data;
+      int value;
+
+      if ((b->s[i].key ^ old) == hash)
+	{
+	  /* keep a deeper result from this search unless ours is exact.  */
+	  if (DATA_AGE (old) == age && DATA_DEPTH (old) > depth && bound != TT_EXACT)
+	    return;
+	  victim = i;
+	  break;
+	}
+      value = DATA_DEPTH (old);
+      if (DATA_AGE (old) == age)
+	value += 256;
+      if (lowest == -1 || value < lowest)
+	{
+	  lowest = value;
+	  victim = i;
+	}
+    }
+
+  data = ((BITSET64) (unsigned int) score)
+    | (((BITSET64) (move + 1) & 0xff) << 32)
+    | (((BITSET64) depth & 0xff) << 40)
+    | (((BITSET64) bound & 0x3) << 48)
+    | (((BITSET64) age & 0xff) << 56);
+  b->s[victim].key = hash ^ data;
+  b->s[victim].data = data;
+}
+
+
+/*
+ *  entries - return the number of entries in the table.
+ */
+
+unsigned long ttable_entries (void)
+{
+  return (unsigned long) ((mask + 1) * SLOTS_PER_BUCKET);
+}
@@ -0,0 +1,102 @@
+/*  ttable.h provides a transposition table for the alpha beta search.
+ *  Positions are identified by a Zobrist hash of the board seen from
+ *  the side to move and each entry is verified by xoring the key with
+ *  its data, so concurrent searchers can share the table without locks.
+ */
+
+#if !defined(ttable_h)
+#  define ttable_h
+#  if defined(ttable_c)
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN
+#     endif /* !__GNUG__.  */
+#  else /* !ttable_c.  */
+#     if defined(__GNUG__)
+#        define EXTERN extern "C"
+#     else /* !__GNUG__.  */
+#        define EXTERN extern
+#     endif /* !__GNUG__.  */
+#  endif /* !ttable_c.  */
+
+#include "board.h"
+
+#define TTABLE_DEFAULT_MB   16
+
+#define TT_NONE             0   /* empty or unused entry.  */
+#define TT_EXACT            1   /* score is exact.  */
+#define TT_LOWER            2   /* score is a lower bound (failed high).  */
+#define TT_UPPER            3   /* score is an upper bound (failed low).  */
+
+#define TT_NOMOVE          -1
+
+typedef struct ttentry_t {
+  int score;
+  int move;      /* best move found or TT_NOMOVE.  */
+  int depth;     /* plies searched below this position.  */
+  int bound;     /* TT_EXACT, TT_LOWER or TT_UPPER.  */
+} ttentry;
+
+
+/*
+ *  init - create a table of at most, megabytes, in size.  The number
+ *         of entries is rounded down to a power of two.  In the
+ *         parallel build the table is placed in shared memory so
+ *         that every search process uses the same table.
+ */
+
+EXTERN void ttable_init (unsigned int megabytes);
+
+
+/*
+ *  newSearch - age every entry in the table by one search.  Entries
+ *              from older searches are replaced in preference.
+ */
+
+EXTERN void ttable_newSearch (void);
+
+
+/*
+ *  hash - return the Zobrist hash of position, b.
+ */
+
+EXTERN BITSET64 ttable_hash (board b);
+
+
+/*
+ *  hashMove - assign, hash, with the hash of the position after the
+ *             side to move plays on square, move, turning over the
+ *             discs in, flips, and, swapped, with the hash of it with
+ *             the sides swapped.  On entry they hold the same for the
+ *             position before the move.
+ */
+
+EXTERN void ttable_hashMove (BITSET64 *hash, BITSET64 *swapped,
+			     int move, BITSET64 flips);
+
+
+/*
+ *  probe - return TRUE if the position, hash, was found and assign
+ *          its contents to, e.
+ */
+
+EXTERN int ttable_probe (BITSET64 hash, ttentry *e);
+
+
+/*
+ *  store - remember the result of searching position, hash.
+ */
+
+EXTERN void ttable_store (BITSET64 hash, int depth, int bound,
+			  int score, int move);
+
+
+/*
+ *  entries - return the number of entries in the table.
+ */
+
+EXTERN unsigned long ttable_entries (void);
+
+#  undef EXTERN
+#endif /* !ttable_h.  */
@@ -1 +1 @@
-#define version_string  "1.0"
+#define version_string  "1.0"